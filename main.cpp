@@ -35,6 +35,28 @@
 #include <iostream>
 #include "string.h"
 #include "math.h"
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include <set>
+#include <tuple>
+#include <mutex>
+#include <charconv>
+#include <chrono>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NOGDI
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 typedef signed long long VLONG;
 typedef unsigned char BYTE;
@@ -51,9 +73,22 @@ const BYTE AKTIVCOL=16;
 
 const int MAXPOLYGONE=16384;
 const int BORDERWIDTH=16;
+const int CHARMAPTILESHIFT=6;
+const int CHARMAPTILE=(1 << CHARMAPTILESHIFT);
 
-enum { CMD_MAKEINT=1, CMD_MAKEEXT, CMD_QUALITY, CMD_ORACLE };
+enum { CMD_MAKEINT=1, CMD_MAKEEXT, CMD_QUALITY, CMD_ORACLE, CMD_TILES, CMD_GENHEADER, CMD_TOBUNDLE, CMD_FROMBUNDLE, CMD_BENCH, CMD_PIPBENCH, CMD_DIFFTEST, CMD_QCMERGE, CMD_AREA };
 enum { PIP_ERROR=-1, PIP_UNKNOWN=0, PIP_INTERIOR, PIP_BOUNDARY, PIP_EXTERIOR };
+enum { SYM_NONE=0, SYM_POINT, SYM_CONJ };
+enum { BENCH_UNIFORM=0, BENCH_NEAREDGE, BENCH_DEEPINT, BENCH_FAREXT, BENCHWORKLOADS };
+enum { DIFF_REFERENCE=0, DIFF_ROWPREPARE, DIFF_PREPAREY, DIFF_TEXT, DIFF_LAZY, DIFF_BUNDLE, DIFFENGINES };
+enum { DIFF_RANDOM=0, DIFF_EDGE, DIFF_VERTEX, DIFF_COLLINEAR, DIFFCATEGORIES };
+enum { QCTEST_SCANLINE=0, QCTEST_PIXEL };
+enum { QCMODE_FULL=0, QCMODE_TIERED };
+enum { LAYOUT_ROWS=0, LAYOUT_TILED };
+enum { QCREPORT_FIRST=0, QCREPORT_ALL };
+enum { QCPHASE_STRUCTURE=0, QCPHASE_BITMAP, QCPHASE_ORACLE, QCPHASE_SMALL };
+enum { QCCACHE_STRUCTURE=0, QCCACHE_REGION, QCCACHE_ORACLE, QCCACHE_EXTERIOR };
+enum { QCF_STRUCTURE=0, QCF_REGION, QCF_DIAGONAL, QCF_VERTEX, QCF_LINE, QCF_ORACLE };
 
 
 // structs
@@ -71,6 +106,12 @@ struct Charmap {
 	VLONG memused;
 	BYTE *cmp;
 	RGB palette[256];
+	// LAYOUT_ROWS: row after row. LAYOUT_TILED: square tiles of
+	// CHARMAPTILE pixels, each stored row by row, the tiles
+	// themselves row by row (tilesx per row). Set by setlenxy
+	// from charmaplayout
+	int layout;
+	VLONG tilesx;
 		
 	Charmap();
 	virtual ~Charmap();
@@ -83,10 +124,59 @@ struct Charmap {
 	void setPaletteRGB(const int,const BYTE,const BYTE,const BYTE);
 	inline void setPoint(const int,const int,const BYTE);
 	inline BYTE getPoint(const int,const int);
+	inline VLONG offset(const int,const int);
+	void getRow(const int,const int,const int,BYTE*);
+	void setRow(const int,const int,const int,const BYTE*);
 	void lineVH(const int,const int,const int,const int,const BYTE);
 	void fillrect(const int,const int,const int,const int,const BYTE);
 };
 
+struct CharmapCursor {
+	// walks a Charmap along a row or a column: inside a tile
+	// (or a row-major image) a step is a pointer increment,
+	// the address is computed anew only at tile borders.
+	// at(dx,dy) reads the 3x3 neighbourhood, from the pointer
+	// unless that crosses a tile border
+	Charmap* map;
+	int x,y;
+	BYTE* p;
+	VLONG zeile; // pointer distance of one row down
+
+	void setTo(Charmap&,const int,const int);
+	inline BYTE get(void);
+	inline void set(const BYTE);
+	inline void right(void);
+	inline void down(void);
+	inline BYTE at(const int,const int);
+};
+
+struct Bitplane {
+	// one bit per pixel, a row is wpr 64-bit words, pixel x
+	// is bit x&63 of word x>>6. Bits beyond xlen stay 0
+	int xlen,ylen,wpr;
+	std::vector<unsigned long long> bits;
+
+	void setlenxy(const int,const int);
+	inline unsigned long long* row(const int);
+	inline int get(const int,const int);
+	inline void set(const int,const int);
+	inline void clear(const int,const int);
+	void setRange(const int,const int,const int);
+	int nextSet(const int,const int,const int);
+};
+
+struct FloodPlanes {
+	// what floodFillPattern leaves for buildPolygon instead
+	// of a byte image: frei: pixels of colour relf not marked,
+	// aktiv: marked ones (AKTIVCOL), blau: boundary pixels
+	// (blue) not yet used by a polygon
+	int relf;
+	Bitplane frei,aktiv,blau;
+
+	void boundary(Bitplane&);
+	void render(Charmap&);
+};
+
 struct PolygonPoint {
 	int x,y;
 };
@@ -100,12 +190,21 @@ struct Polygon {
 	double cx0,cx1,cy0,cy1;
 	int xmin,xmax,ymin,ymax;
 	int* yprepare;
+	// lazy>0: only header and bounding box are loaded,
+	// vertices are read from lazyfn on first use
+	std::atomic<int> lazy;
+	char* lazyfn;
+	// points lie in a memory-mapped bundle, not owned
+	int mapped;
 		
 	Polygon();
 	virtual ~Polygon();
 		
 	void setlen(const int);
 	int load(const char*);
+	int loadHeader(const char*);
+	int parseText(const char*,const char*,char*);
+	void ensureLoaded(void);
 	void save(const char*);
 	void add(const int,const int);
 	void trimColinearStart(void);
@@ -113,13 +212,271 @@ struct Polygon {
 	int isDiagonalFree(void);
 	void unPrepareY(void);
 	void prepareY(const int);
+	void prepareYTo(const int,int*);
+};
+
+// binary polygon bundle, see writeBundle
+struct BundleHeader {
+	char magic[8]; // "JPBUNDLE"
+	int version;
+	int intpcount,extpcount;
+	int reserved[11];
+};
+
+struct BundleEntry {
+	VLONG nenner;
+	VLONG offset; // of the vertex array from the start of the file
+	int pointcount;
+	int xmin,xmax,ymin,ymax;
+	int cx0,cx1,cy0,cy1;
+	int reserved;
+};
+
+struct PolygonSet {
+	// one complete set of interior and exterior polygons,
+	// e.g. one level of an oracle cascade
+	Polygon *intp,*extp;
+	int intpcount,extpcount;
+	int symmetry; // SYM_, only one half stored if not SYM_NONE
+	
+	PolygonSet();
+	virtual ~PolygonSet();
+	
+	void load(const char*,const int =0);
+};
+
+struct OracleCounters {
+	// hot-path statistics of the oracle, only collected
+	// if compiled with -DORACLECOUNTERS
+	VLONG verdict[4]; // jsoracleWith results, indexed by PIP_
+	VLONG polygons; // polygons whose stencil was evaluated
+	VLONG bboxrejects; // point_in_polygonVH calls and lazy polygons cut by the bounding box
+	VLONG pipcalls;
+	VLONG edges; // segments walked in point_in_polygonVH
+	VLONG boundary; // point_in_polygonVH results BOUNDARY
+	VLONG earlyexits; // stencils left before the 25th grid point
+	
+	OracleCounters();
+	
+	void add(const OracleCounters&);
+};
+
+#ifdef ORACLECOUNTERS
+struct CounterSlot {
+	// thread-private counters, added to the global
+	// sum when the thread ends
+	OracleCounters c;
+	
+	virtual ~CounterSlot();
+};
+#endif
+
+struct RowPrepare {
+	// thread-private version of Polygon::yprepare for
+	// all loaded polygons, so several threads can work
+	// on different rows at the same time
+	int **intprep,**extprep;
+	int intanz,extanz;
+	
+	RowPrepare();
+	virtual ~RowPrepare();
+	
+	void prepare(const double);
+};
+
+struct ScanVertical {
+	int x,miy,may;
+	int yend; // y of the vertex the segment ends in
+	int endtoggle; // a ray through yend changes the parity
+};
+
+struct ScanHorizontal {
+	int y,minx,maxx;
+	int toggle; // a ray colinear with the segment changes the parity
+};
+
+struct ScanSweep {
+	// thread-private sweep state over one ScanPolygon. Rows
+	// are best asked for in increasing order, otherwise the
+	// active segment list is built anew
+	std::vector<int> aktiv;
+	int naechste,lastrow;
+	std::vector<int> events;
+	std::vector<std::pair<int,int> > rand;
+
+	ScanSweep();
+};
+
+struct ScanPolygon {
+	// classifies a whole grid row of one polygon at once,
+	// same rules as point_in_polygonVH. Read-only after
+	// init, shared by all threads
+	Polygon* pg;
+	std::vector<ScanVertical> vert; // sorted by miy
+	std::vector<ScanHorizontal> hor; // sorted by y
+
+	void init(Polygon*);
+	void row(ScanSweep&,const int,const int,std::vector<VLONG>&);
+	int classify(const int,const int);
+};
+
+struct ScanSet {
+	// scanline version of jsoracleWith for the interior-only
+	// and exterior-only questions of the QC C-test, all
+	// polygons must share one denominator
+	std::vector<ScanPolygon> intsp,extsp;
+	VLONG nenner;
+
+	int init(Polygon*,const int,Polygon*,const int);
+};
+
+struct ScanCursor {
+	// thread-private: classifies one image row at a time
+	ScanSet* set;
+	std::vector<ScanSweep> intsw,extsw;
+	std::vector<VLONG> iv,iv2,schnitt,treffer;
+	std::vector<int> dint,dext;
+
+	ScanCursor(ScanSet*);
+	int stencil(ScanPolygon&,ScanSweep&,const int,const int,std::vector<VLONG>&);
+	void classifyRow(const double,const int*,const int,BYTE*,BYTE*);
+};
+
+const unsigned short QCNOOWNER=0xFFFF;
+const int QCREPORTMAX=100000; // entries written to _QC_report.csv
+const char QCCHECKPOINTFN[]="_QC_checkpoint.txt";
+const unsigned long long FNVSTART=14695981039346656037ULL;
+const char QCCACHEFN[]="_QC_cache.txt";
+const char QCSHARDFN[]="_QC_shard_%i.txt";
+
+struct QcOverlay {
+	// per pixel the lowest index of the polygons drawn onto
+	// it (QCNOOWNER if none). qcB of polygon j sees the image
+	// as if polygons 0..j-1 were drawn, for all j in parallel
+	int xlen,ylen;
+	std::atomic<unsigned short>* owner;
+
+	QcOverlay(const int,const int);
+	virtual ~QcOverlay();
+
+	void drawPolygon(Polygon&,const int);
+	int drawnBefore(const int,const int,const int);
+};
+
+struct GeoSegment {
+	// polygon edge points[index-1] -> points[index] in pixel
+	// coordinates. polygon: 0..intpcount-1 interior, then exterior
+	int x0,x1,y0,y1;
+	int polygon,index;
+};
+
+struct IntervalTreap {
+	// y-intervals of the segments at the sweep line: treap
+	// ordered by (lo,seg), every node knows the largest upper
+	// end in its subtree
+	struct Knoten {
+		int lo,hi,maxhi;
+		unsigned int prio;
+		int links,rechts;
+		int seg;
+	};
+	std::vector<Knoten> knoten;
+	std::vector<int> frei;
+	int wurzel;
+	unsigned long long zufall;
+
+	IntervalTreap();
+
+	void insert(const int,const int,const int);
+	void erase(const int,const int);
+	void query(const int,const int,std::vector<int>&);
+	void update(const int);
+	void split(const int,const int,const int,int&,int&);
+	int merge(const int,const int);
+	void queryFrom(const int,const int,const int,std::vector<int>&);
+};
+
+struct QcReport {
+	// QCREPORT=ALL: every failing location instead of the
+	// first one. check: QCF_..., polygon: number within its
+	// kind (-1 if not known), pixel box x0..x1,y0..y1
+	struct Eintrag {
+		int check,ext,polygon;
+		int x0,y0,x1,y1;
+	};
+	std::vector<Eintrag> eintraege;
+	// entries already there: a pixel shared by two edges
+	// (a vertex) is found by both, it counts once
+	std::set<std::tuple<int,int,int,int,int,int,int>> gesehen;
+	VLONG anzahl;
+	std::mutex mutex;
+
+	QcReport();
+
+	void add(const int,const int,const int,const int,const int,const int,const int);
+	int save(const char*);
+	void annotate(Charmap&);
+};
+
+struct QcCheckpoint {
+	// progress of a QC run for RESUME=1: the phase reached
+	// and the finished rows of the oracle test, tied to the
+	// hash of the inputs
+	unsigned long long hash;
+	int phase;
+	std::vector<BYTE> erledigt;
+	std::mutex mutex;
+	std::chrono::steady_clock::time_point letzte;
+
+	QcCheckpoint();
+
+	int load(const char*);
+	int save(const char*);
+	int due(void);
+	void advance(const int);
+	void rowDone(const int);
+	int isDone(const int);
+};
+
+struct QcCache {
+	// QCCACHE=1: hashes of the checks passed, per kind
+	// (QCCACHE_...). A polygon whose key is found does not
+	// need that check again
+	std::vector<unsigned long long> keys[4];
+
+	int load(const char*);
+	int save(const char*);
+	void add(const int,const unsigned long long);
+	int has(const int,const unsigned long long);
+};
+
+struct QcShardResult {
+	// SHARD=i/n: what one process found, for CMD=QCMERGE.
+	// Per check the lowest failing polygon (numbered over
+	// both kinds, interior first), -1 passed, -2 not run as
+	// an earlier check failed. Oracle: kind (as qcOracleError)
+	// and pixel of the lowest failure, same -1/-2 in oracleart
+	unsigned long long hash;
+	int shard,shards;
+	int structure,region,touch;
+	int oracleart,oraclex,oracley;
+
+	QcShardResult();
+
+	int load(const char*);
+	int save(const char*);
+	void merge(QcShardResult&);
+	int complete(void);
 };
 
 
 // globals
 
 Charmap inbild;
+int charmaplayout=LAYOUT_ROWS;
 int granularity=5;
+int kernelstride=0; // 0: granularity
+int kerneloffset=0;
 FILE *flog=NULL;
 int RANGE0=-2,RANGE1=2;
 int SCREENBREITE;
@@ -127,6 +484,39 @@ double skalaRangeProPixel;
 int intpcount=0,extpcount=0;
 Polygon *intp=NULL,*extp=NULL;
 int LOWERBOUNDPOLYGONLENGTH=24;
+int threadcount=0; // 0 = number of hardware threads
+int TILESIZE=256;
+int TILELEVELS=4;
+int lazyload=0;
+std::mutex lazymutex;
+char bundlefn[1024]="";
+const int BUNDLEALIGN=64;
+char polypath[1024]=""; // prefix of the polygon file names
+char genname[1024]="JSPOLYGONS";
+const int MAXCASCADE=16;
+int cascadecount=0;
+char cascadepath[MAXCASCADE][1024];
+PolygonSet* cascade=NULL;
+int symmetry=SYM_NONE; // of the global polygon set
+int symmetryarg=-1; // from the command line, -1 = not given
+int qcgeometric=1;
+int qctest=QCTEST_SCANLINE;
+int qcmode=QCMODE_FULL;
+int qcreport=QCREPORT_FIRST;
+int qcresume=0;
+int qccheckpointsek=60;
+int qccache=0;
+int qcsamples=65536;
+int qcshard=0,qcshards=0; // SHARD=i/n, 0 shards: not sharded
+QcShardResult* qcmerged=NULL; // CMD=QCMERGE: the shards' results
+int BENCHCOUNT=100000;
+int MAXVERTICES=10000000;
+int DIFFCOUNT=20000;
+OracleCounters countertotal;
+std::mutex countermutex;
+#ifdef ORACLECOUNTERS
+thread_local CounterSlot counterslot;
+#endif
 
 
 // forward
@@ -149,35 +539,102 @@ int LOWERBOUNDPOLYGONLENGTH=24;
 	if (flog) fprintf(flog,TT,TT2,TT3);\
 }
 
+#ifdef ORACLECOUNTERS
+#define COUNT(FELD) counterslot.c.FELD++;
+#define COUNTIF(COND,FELD) if (COND) counterslot.c.FELD++;
+#else
+#define COUNT(FELD)
+#define COUNTIF(COND,FELD)
+#endif
+
 // functions corresponding to CMD_
 
 int interiorPolygon(void);
 int exteriorPolygon(void);
-int jsoracle(const double,const double);
+int jsoracle(const double,const double,RowPrepare* =NULL);
+int jsoracleExteriorOnly(const double,const double,RowPrepare* =NULL);
+int jsoracleInteriorOnly(const double,const double,RowPrepare* =NULL);
+int jsoracleWith(Polygon*,const int,Polygon*,const int,const double,const double,RowPrepare* =NULL);
+int jsoracleCascade(const double,const double,int&);
 int qualitycontrol(void);
+int qcChecks(QcCheckpoint*&,QcCache*&,QcReport*&);
+void qcReportWrite(QcReport&);
+int tilePyramid(void);
+int polygonArea(void);
+int generateHeader(void);
+int benchmark(void);
+int pipBenchmark(void);
+int diffTest(void);
+void writeOracleCounters(FILE*,const int);
+void oracleCountersAtExit(void);
 
 // constructing and testing functions
 
 void oracle(const char*,const double,const double);
 void oracleComplexNumber(const double,const double);
-int point_in_polygonVH(Polygon&,const int,const int);
+int point_in_polygonVH(Polygon&,const int,const int,const int* =NULL);
 int qualitycontrol(Polygon& apg,const BYTE);
-int buildPolygon(Charmap*,const char*);
-Charmap* floodFillPattern(const int);
+int qcBRegion(Charmap&,Polygon&,const BYTE,QcOverlay*,const int,QcReport* =NULL);
+int qcB2(Charmap&,Polygon&,const BYTE,const BYTE,const int,QcReport* =NULL,const int =0);
+int qcGeometric(void);
+int qcPixelVerdict(const int,const int);
+int qcOracleOwner(const int,const int,const int);
+unsigned long long qcInputHash(void);
+unsigned long long qcPolygonHash(Polygon&,const int);
+void qcPixelBox(Polygon&,const int,int&,int&,int&,int&);
+unsigned long long qcImageHash(unsigned long long,Charmap&,const int,const int,const int,const int);
+int qcOracleMargin(Polygon&);
+int qcCacheOracleMode(QcCache&,std::vector<unsigned long long>&,const unsigned long long);
+int qcOracleBoxes(QcCache&,std::vector<unsigned long long>&);
+int qcOracleTest(QcCheckpoint*,QcReport*,const int =0,const int =1,int* =NULL);
+int qcShard(void);
+int qcMerge(void);
+int qcSampleTest(const int);
+inline unsigned long long benchRandom(unsigned long long&);
+void qcBDraw(Charmap&,Polygon&,const BYTE);
+int buildPolygon(FloodPlanes*,const char*);
+FloodPlanes* floodFillPattern(const int);
+void setPaletteTo(Charmap&);
 int preapreYOracle(const double);
 void unPrepareYOracle(void);
 int borderPresent(Charmap&);
 
 // helper function
-void loadAllPolygons(void);
+void loadAllPolygons(const int =0);
+void loadPolygons(const char*,Polygon*&,int&,Polygon*&,int&,const int =0);
+int fileExists(const char*);
+int writeBundle(const char*);
+int mapBundle(const char*,Polygon*&,int&,Polygon*&,int&,int* =NULL);
+int loadSymmetry(const char*);
+int saveSymmetry(const char*,const int);
+int imageSymmetric(Charmap&,const int);
+int polygonsToBundle(void);
+int bundleToPolygons(void);
 void drawCrossing(Charmap*,const int,const int,const BYTE);
 void drawAllPolygons(Charmap&);
 void drawOnePolygon(Charmap&,Polygon&,const BYTE);
 int inbildcoord(const double);
+int getThreadCount(void);
+void parallelIndex(const int,const std::function<void(const int,const int)>&);
 
 
 // small functions
 
+inline void foldSymmetry(const int asym,double& ax,double& ay) {
+	// maps a point of the lower half plane onto its
+	// mirror image in the stored upper half
+	if ( (asym == SYM_NONE) || (ay >= 0.0) ) return;
+	if (asym == SYM_POINT) ax=-ax;
+	ay=-ay;
+}
+
+inline double foldSymmetryY(const int asym,const double ay) {
+	// both symmetries negate the imaginary part of the
+	// lower half, so a row folds as a whole
+	if ( (asym == SYM_NONE) || (ay >= 0.0) ) return ay;
+	return -ay;
+}
+
 inline int inbildcoord(const double w) {
 	return (int)floor( (w - RANGE0) / skalaRangeProPixel );
 }
@@ -192,10 +649,52 @@ inline int maximumI(const int a,const int b) {
 	return b;
 }
 
+inline unsigned long long fnv1a(unsigned long long h,const void* p,const VLONG n) {
+	// 64 bit FNV-1a, h: hash so far (or FNVSTART)
+	const BYTE* b=(const BYTE*)p;
+	for(VLONG i=0;i<n;i++) {
+		h ^= b[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
 inline void getMinMax(const int a,const int b,int& mi,int& ma) {
 	if (a < b) { mi=a; ma=b; } else { mi=b; ma=a; }
 }
 
+inline int lowestBit(const unsigned long long v) {
+	// index of the lowest set bit of v != 0 (de Bruijn
+	// multiplication, no compiler intrinsics needed)
+	static const int tab[64]={
+		0,1,48,2,57,49,28,3,61,58,50,42,38,29,17,4,
+		62,55,59,36,53,51,43,22,45,39,33,30,24,18,12,5,
+		63,47,56,27,60,41,37,16,54,35,52,21,44,32,23,11,
+		46,26,40,15,34,20,31,10,25,14,19,9,13,8,7,6
+	};
+	return tab[((v & (0-v))*0x03f79d71b4cb0a89ULL) >> 58];
+}
+
+void bitsShift(const unsigned long long* src,unsigned long long* dst,const int wpr,const int k) {
+	// bit rows of wpr words: bit x of dst is bit x+k of src
+	// (0 outside), k of either sign. dst != src
+	int q=( (k >= 0) ? k : -k ) >> 6;
+	int r=( (k >= 0) ? k : -k ) & 63;
+	for(int w=0;w<wpr;w++) {
+		unsigned long long v=0;
+		if (k >= 0) {
+			int s=w+q;
+			if (s < wpr) v=src[s] >> r;
+			if ( (r > 0) && ((s+1) < wpr) ) v |= src[s+1] << (64-r);
+		} else {
+			int s=w-q;
+			if (s >= 0) v=src[s] << r;
+			if ( (r > 0) && ((s-1) >= 0) ) v |= src[s-1] >> (64-r);
+		}
+		dst[w]=v;
+	}
+}
+
 char* chomp(char* s) {
 	if (!s) return 0;
 	for(int i=strlen(s);i>=0;i--) if (s[i]<32) s[i]=0; else break;
@@ -212,6 +711,42 @@ char* upper(char* s) {
 }
 
 
+// threading
+
+int getThreadCount(void) {
+	if (threadcount > 0) return threadcount;
+	
+	int n=(int)std::thread::hardware_concurrency();
+	if (n <= 0) n=1;
+	
+	return n;
+}
+
+void parallelIndex(const int anz,const std::function<void(const int,const int)>& afkt) {
+	// distributes the indices 0..anz-1 dynamically over
+	// the worker threads and calls afkt(index,threadnumber)
+	// threadnumber lies in 0..getThreadCount()-1
+	
+	int tc=minimumI(getThreadCount(),anz);
+	if (tc <= 1) {
+		for(int i=0;i<anz;i++) afkt(i,0);
+		return;
+	}
+	
+	std::atomic<int> next(0);
+	std::thread *worker=new std::thread[tc];
+	for(int t=0;t<tc;t++) {
+		worker[t]=std::thread([&,t]() {
+			int idx;
+			while ( (idx=next++) < anz ) afkt(idx,t);
+		});
+	}
+	for(int t=0;t<tc;t++) worker[t].join();
+	
+	delete[] worker;
+}
+
+
 // struct Polygon
 
 int Polygon::isDiagonalFree(void) {
@@ -299,7 +834,10 @@ int Polygon::load(const char* afn) {
 	
 	nenner=0;
 	fgets(tmp,1000,f); chomp(tmp);
-	if (sscanf(tmp,"%I64d",&nenner) != 1) nenner=1 << 25;
+	// %lld: %I64d is no 64 bit conversion outside Windows
+	long long nn=0;
+	if (sscanf(tmp,"%lld",&nn) != 1) nn=1 << 25;
+	nenner=nn;
 	fgets(tmp,1000,f); chomp(tmp);
 	if (sscanf(tmp,"%lf,%lf,%lf,%lf",&cx0,&cx1,&cy0,&cy1) != 4) {
 		cx0=cy0=RANGE0;
@@ -343,8 +881,12 @@ void Polygon::save(const char* afn) {
 	FILE *f=fopen(afn,"wt");
 	if (!f) return;
 	
-	fprintf(f,"%I64d\n",nenner);
-	fprintf(f,"%i,%i,%i,%i\n",RANGE0,RANGE1,RANGE0,RANGE1);
+	fprintf(f,"%lld\n",(long long)nenner);
+	// range and bounding box (the latter for lazy loading,
+	// older versions only read the first four numbers)
+	fprintf(f,"%i,%i,%i,%i,%i,%i,%i,%i\n",
+		(int)cx0,(int)cx1,(int)cy0,(int)cy1,
+		xmin,xmax,ymin,ymax);
 	fprintf(f,"%i\n",pointcount);
 	for(int i=0;i<pointcount;i++) {
 		fprintf(f,"%i,%i\n",points[i].x,points[i].y);
@@ -354,21 +896,208 @@ void Polygon::save(const char* afn) {
 	fclose(f);
 }
 
+inline const char* nextLine(const char* p,const char* ende) {
+	while ( (p < ende) && (*p != '\n') ) p++;
+	if (p < ende) p++;
+	return p;
+}
+
+inline const char* skipBlank(const char* p,const char* ende) {
+	while ( (p < ende) && ( (*p == ' ') || (*p == '\t') ) ) p++;
+	return p;
+}
+
+int Polygon::parseText(const char* abuf,const char* aende,char* afehler) {
+	// parses a complete polygon file held in memory (must be
+	// followed by a 0 byte). Same format and results as load(),
+	// but the vertex array is sized exactly by the point count
+	// and no yprepare array is allocated (done on demand).
+	// returns 1 or 0 with a message in afehler
+	const char* p=abuf;
+	
+	// denominator
+	p=skipBlank(p,aende);
+	VLONG nn=0;
+	std::from_chars_result r=std::from_chars(p,aende,nn);
+	nenner=( (r.ec == std::errc()) ? nn : (1 << 25) );
+	p=nextLine(p,aende);
+	
+	// range, a stored bounding box is recomputed below
+	double c[4];
+	int ok=1;
+	const char* q=p;
+	for(int k=0;k<4;k++) {
+		char* e2;
+		c[k]=strtod(q,&e2);
+		if (e2 == q) { ok=0; break; }
+		q=e2;
+		if (k < 3) {
+			if (*q != ',') { ok=0; break; }
+			q++;
+		}
+	}
+	if (ok > 0) {
+		cx0=c[0]; cx1=c[1]; cy0=c[2]; cy1=c[3];
+	} else {
+		cx0=cy0=RANGE0;
+		cx1=cy1=RANGE1;
+	}
+	p=nextLine(p,aende);
+	
+	// point count
+	p=skipBlank(p,aende);
+	int a=0;
+	r=std::from_chars(p,aende,a);
+	if ( (r.ec != std::errc()) || (a < 0) ) {
+		strcpy(afehler,"ERROR. Polygon file not correct in point count.\n");
+		return 0;
+	}
+	p=nextLine(p,aende);
+	
+	if ( (points) && (mapped<=0) ) delete[] points;
+	if (yprepare) delete[] yprepare;
+	yprepare=NULL;
+	useprepare=0;
+	mapped=0;
+	memused=a;
+	points=new PolygonPoint[maximumI(a,1)];
+	pointcount=a;
+	
+	for(int i=0;i<pointcount;i++) {
+		const char* zeile=p;
+		int ax,ay;
+		q=skipBlank(p,aende);
+		r=std::from_chars(q,aende,ax);
+		ok=0;
+		if ( (r.ec == std::errc()) && (r.ptr < aende) && (*r.ptr == ',') ) {
+			r=std::from_chars(r.ptr+1,aende,ay);
+			if (r.ec == std::errc()) ok=1;
+		}
+		if (ok <= 0) {
+			int len=(int)(nextLine(zeile,aende)-zeile);
+			if (len > 200) len=200;
+			sprintf(afehler,"ERROR. Polygon file not correct in point line %.*s.\n",len,zeile);
+			chomp(afehler);
+			strcat(afehler,"\n");
+			return 0;
+		}
+		points[i].x=ax;
+		points[i].y=ay;
+		if (i==0) {
+			xmin=xmax=ax;
+			ymin=ymax=ay;
+		} else {
+			if ( (ax-8) < xmin) xmin=ax-8;
+			if ( (ax+8) > xmax) xmax=ax+8;
+			if ( (ay-8) < ymin) ymin=ay-8;
+			if ( (ay+8) > ymax) ymax=ay+8;
+		}
+		p=nextLine(r.ptr,aende);
+	}
+	
+	return 1;
+}
+
+int Polygon::loadHeader(const char* afn) {
+	// reads denominator, range, bounding box and point
+	// count only. The vertices follow on first use, see
+	// ensureLoaded()
+	FILE *f=fopen(afn,"rt");
+	if (!f) return -1;
+	char tmp[1024];
+	
+	nenner=0;
+	fgets(tmp,1000,f); chomp(tmp);
+	// %lld: %I64d is no 64 bit conversion outside Windows
+	long long nn=0;
+	if (sscanf(tmp,"%lld",&nn) != 1) nn=1 << 25;
+	nenner=nn;
+	fgets(tmp,1000,f); chomp(tmp);
+	int anz=sscanf(tmp,"%lf,%lf,%lf,%lf,%i,%i,%i,%i",&cx0,&cx1,&cy0,&cy1,&xmin,&xmax,&ymin,&ymax);
+	if (anz < 4) {
+		cx0=cy0=RANGE0;
+		cx1=cy1=RANGE1;
+	}
+	fgets(tmp,1000,f); chomp(tmp);
+	int a;
+	if (sscanf(tmp,"%i",&a) != 1) {
+		LOGMSG("ERROR. Polygon file not correct in point count.\n");
+		exit(99);
+	}
+	fclose(f);
+	
+	if (anz != 8) {
+		// file of an older version without bounding box:
+		// load completely, the box is computed in memory. The
+		// file stays as it is, saving it anew (cmd=MAKEINT etc.)
+		// adds the box
+		static std::atomic<int> gemeldet(0);
+		if (gemeldet.exchange(1) == 0) {
+			LOGMSG2("\nPolygon file %s (and maybe others) without bounding box, read completely.\n",afn);
+		}
+		return load(afn);
+	}
+	
+	if (points) delete[] points;
+	points=NULL;
+	pointcount=a;
+	memused=0;
+	if (lazyfn) delete[] lazyfn;
+	lazyfn=new char[strlen(afn)+1];
+	strcpy(lazyfn,afn);
+	lazy=1;
+	
+	return 1;
+}
+
+void Polygon::ensureLoaded(void) {
+	// several threads may ask at the same time. The fields
+	// other threads might be reading (pointcount, bounding box)
+	// already have their final value, only points and
+	// yprepare are set here before the lazy flag is cleared
+	if (lazy.load(std::memory_order_acquire) <= 0) return;
+	
+	std::lock_guard<std::mutex> lock(lazymutex);
+	if (lazy.load(std::memory_order_acquire) <= 0) return;
+	
+	Polygon tmp;
+	if (tmp.load(lazyfn) <= 0) {
+		LOGMSG2("\nERROR. Polygon file %s vanished.\n",lazyfn);
+		exit(99);
+	}
+	if (tmp.pointcount != pointcount) {
+		LOGMSG2("\nERROR. Polygon file %s changed while in use.\n",lazyfn);
+		exit(99);
+	}
+	
+	points=tmp.points;
+	yprepare=tmp.yprepare;
+	memused=tmp.memused;
+	tmp.points=NULL;
+	tmp.yprepare=NULL;
+	lazy.store(0,std::memory_order_release);
+}
+
 Polygon::Polygon() {
 	pointcount=0;
 	points=NULL;
 	memused=0;
 	useprepare=0;
 	yprepare=NULL;
+	lazy=0;
+	lazyfn=NULL;
+	mapped=0;
 }
 
 Polygon::~Polygon() {
-	if (points) delete[] points;
+	if ( (points) && (mapped<=0) ) delete[] points;
 	if (yprepare) delete[] yprepare;
+	if (lazyfn) delete[] lazyfn;
 }
 
 void Polygon::setlen(const int a) {
 	if (points) delete[] points;
+	if (yprepare) delete[] yprepare;
 	memused=a;
 	points=new PolygonPoint[memused];
 	pointcount=0;
@@ -378,7 +1107,25 @@ void Polygon::setlen(const int a) {
 }
 
 void Polygon::prepareY(const int ay) {
+	// mapped polygons get their array on first use
+	if (!yprepare) yprepare=new int[maximumI(pointcount,1)];
 	useprepare=1;
+	prepareYTo(ay,yprepare);
+}
+
+void Polygon::prepareYTo(const int ay,int* ziel) {
+	// chain of segment indices that can intersect
+	// rows ay-2..ay+2, stored in ziel (at least
+	// pointcount entries)
+	if (lazy > 0) {
+		// rows outside the bounding box need no vertices
+		if ( ((ay+2) < ymin) || ((ay-2) > ymax) ) {
+			ziel[0]=(pointcount+16);
+			return;
+		}
+		ensureLoaded();
+	}
+	
 	int li=-1;
 	int BUFFER=2; // to account for rounding errors
 	// "too many" intersections are considered valid
@@ -395,82 +1142,385 @@ void Polygon::prepareY(const int ay) {
 			) 
 		) {
 			if (li >= 0) {
-				yprepare[li]=i;
+				ziel[li]=i;
 			} else {
-				yprepare[0]=i; // first entry
+				ziel[0]=i; // first entry
 			}
 			li=i;
 		}
 	}
 	
-	useprepare=1;
-
 	// jump to after the end of the polygon
 	if (li>=0) {
-		yprepare[li]=(pointcount+16);
+		ziel[li]=(pointcount+16);
 	} else {
-		yprepare[0]=(pointcount+16);
+		ziel[0]=(pointcount+16);
 		// if no intersection occurs at all => nothing to test
 	}
 }
 
-void Polygon::unPrepareY(void) {
-	useprepare=0;
+
+// struct RowPrepare
+
+RowPrepare::RowPrepare() {
+	// polygons must already be loaded
+	intanz=intpcount;
+	extanz=extpcount;
+	intprep=new int*[intanz+1];
+	extprep=new int*[extanz+1];
+	for(int i=0;i<intanz;i++) intprep[i]=new int[maximumI(intp[i].pointcount,1)];
+	for(int i=0;i<extanz;i++) extprep[i]=new int[maximumI(extp[i].pointcount,1)];
 }
 
-void Polygon::add(const int ax,const int ay) {
-	// adds and checks directly for colinear segments
-	
-	if (pointcount > (memused-8)) {
-		// memory is getting filled => allocate bigger part
+RowPrepare::~RowPrepare() {
+	for(int i=0;i<intanz;i++) delete[] intprep[i];
+	for(int i=0;i<extanz;i++) delete[] extprep[i];
+	delete[] intprep;
+	delete[] extprep;
+}
 
-		int mem2=memused+16384;
-		PolygonPoint *p2=new PolygonPoint[mem2];
-		for(int i=0;i<pointcount;i++) {
-			p2[i].x=points[i].x;
-			p2[i].y=points[i].y;
-		}
-		delete[] points;
-		points=p2;
-		memused=mem2;
-	}
-	
-	if (pointcount == 0) {
-		xmin=xmax=ax;
-		ymin=ymax=ay;
-	} else {
-		if ( (ax-8) < xmin) xmin=ax-8;
-		if ( (ax+8) > xmax) xmax=ax+8;
-		if ( (ay-8) < ymin) ymin=ay-8;
-		if ( (ay+8) > ymax) ymax=ay+8;
+void RowPrepare::prepare(const double ay0) {
+	double ay=foldSymmetryY(symmetry,ay0);
+	for(int i=0;i<intanz;i++) {
+		int py=(int)floor(ay*intp[i].nenner);
+		intp[i].prepareYTo(py,intprep[i]);
 	}
-	
-	if (pointcount >= 2) {
-		// ...A,B, new point
-		if ( 
-			(ax == points[pointcount-1].x) &&
-			(ax == points[pointcount-2].x)
-		) {
-			// if colinear, then remove B
-			points[pointcount-1].x=ax;
-			points[pointcount-1].y=ay;
-		} else
-		if ( 
-			(ay == points[pointcount-1].y) &&
-			(ay == points[pointcount-2].y)
-		) {
-			points[pointcount-1].x=ax;
-			points[pointcount-1].y=ay;
-		} else {
-			// point added
-			points[pointcount].x=ax;
-			points[pointcount].y=ay;
-			pointcount++;
-		}
-	} else {
-		points[pointcount].x=ax;
-		points[pointcount].y=ay;
-		pointcount++;
+	for(int i=0;i<extanz;i++) {
+		int py=(int)floor(ay*extp[i].nenner);
+		extp[i].prepareYTo(py,extprep[i]);
+	}
+}
+
+
+// struct ScanPolygon
+
+// interval lists are flat pairs a0,b0,a1,b1,... of
+// inclusive, sorted, non-adjacent grid x ranges
+const VLONG SCANUNENDLICH=(VLONG)1 << 40;
+
+inline void scanEmit(std::vector<VLONG>& aiv,const VLONG a,const VLONG b) {
+	if (a > b) return;
+	int n=(int)aiv.size();
+	if ( (n > 0) && ((aiv[n-1]+1) >= a) ) {
+		if (b > aiv[n-1]) aiv[n-1]=b;
+		return;
+	}
+	aiv.push_back(a);
+	aiv.push_back(b);
+}
+
+ScanSweep::ScanSweep() {
+	naechste=0;
+	lastrow=-0x7FFFFFFF;
+}
+
+void ScanPolygon::init(Polygon* apg) {
+	pg=apg;
+	pg->ensureLoaded();
+	vert.clear();
+	hor.clear();
+
+	int pc=pg->pointcount;
+	PolygonPoint* p=pg->points;
+	for(int i=1;i<pc;i++) {
+		int y2=( (i<(pc-1)) ? p[i+1].y : p[1].y );
+		if (p[i].x == p[i-1].x) {
+			ScanVertical v;
+			v.x=p[i].x;
+			v.miy=minimumI(p[i].y,p[i-1].y);
+			v.may=maximumI(p[i].y,p[i-1].y);
+			v.yend=p[i].y;
+			int y0=p[i-1].y;
+			v.endtoggle=( ((y0<v.yend)&&(v.yend<y2)) || ((y0>v.yend)&&(v.yend>y2)) );
+			vert.push_back(v);
+		} else
+		if (p[i].y == p[i-1].y) {
+			ScanHorizontal h;
+			h.y=p[i].y;
+			h.minx=minimumI(p[i].x,p[i-1].x);
+			h.maxx=maximumI(p[i].x,p[i-1].x);
+			int y0=( (i>1) ? p[i-2].y : p[pc-2].y );
+			h.toggle=( ((y0<h.y)&&(h.y<y2)) || ((y0>h.y)&&(h.y>y2)) );
+			hor.push_back(h);
+		}
+		// diagonals do not occur, point_in_polygonVH stops on them
+	}
+
+	std::sort(vert.begin(),vert.end(),[](const ScanVertical& a,const ScanVertical& b) { return a.miy < b.miy; });
+	std::sort(hor.begin(),hor.end(),[](const ScanHorizontal& a,const ScanHorizontal& b) { return a.y < b.y; });
+}
+
+void ScanPolygon::row(ScanSweep& asw,const int ay,const int aklasse,std::vector<VLONG>& aiv) {
+	// all grid x in row ay where point_in_polygonVH
+	// gives aklasse (PIP_INTERIOR or PIP_EXTERIOR)
+	aiv.clear();
+	if ( (ay < pg->ymin) || (ay > pg->ymax) ) {
+		if (aklasse == PIP_EXTERIOR) scanEmit(aiv,-SCANUNENDLICH,SCANUNENDLICH);
+		return;
+	}
+
+	std::vector<int>& aktiv=asw.aktiv;
+	std::vector<int>& events=asw.events;
+	std::vector<std::pair<int,int> >& rand=asw.rand;
+	if (ay < asw.lastrow) {
+		aktiv.clear();
+		asw.naechste=0;
+	}
+	asw.lastrow=ay;
+	while ( (asw.naechste < (int)vert.size()) && (vert[asw.naechste].miy <= ay) ) aktiv.push_back(asw.naechste++);
+	int n=0;
+	for(int k=0;k<(int)aktiv.size();k++) {
+		if (vert[aktiv[k]].may >= ay) aktiv[n++]=aktiv[k];
+	}
+	aktiv.resize(n);
+
+	// the ray from ax to the right changes parity at every
+	// event with ax < event
+	events.clear();
+	rand.clear();
+	for(int k=0;k<n;k++) {
+		ScanVertical& v=vert[aktiv[k]];
+		rand.push_back(std::make_pair(v.x,v.x));
+		if (ay == v.yend) {
+			if (v.endtoggle) events.push_back(v.x);
+		} else
+		if ( (v.miy < ay) && (ay < v.may) ) events.push_back(v.x);
+	}
+	auto h=std::lower_bound(hor.begin(),hor.end(),ay,[](const ScanHorizontal& a,const int y) { return a.y < y; });
+	for(;( (h != hor.end()) && (h->y == ay) );++h) {
+		rand.push_back(std::make_pair(h->minx,h->maxx));
+		if (h->toggle) events.push_back(h->minx);
+	}
+	std::sort(events.begin(),events.end());
+	std::sort(rand.begin(),rand.end());
+
+	if (aklasse == PIP_EXTERIOR) scanEmit(aiv,-SCANUNENDLICH,(VLONG)pg->xmin-1);
+
+	// runs of constant parity within the bounding box,
+	// minus the boundary
+	int ne=(int)events.size();
+	int j=(int)(std::upper_bound(events.begin(),events.end(),pg->xmin)-events.begin());
+	int r=0;
+	VLONG start=pg->xmin;
+	while (start <= pg->xmax) {
+		VLONG ende=( (j<ne) ? (VLONG)events[j] : (VLONG)pg->xmax+1 );
+		if (ende > ((VLONG)pg->xmax+1)) ende=(VLONG)pg->xmax+1;
+		int ungerade=((ne-j) & 1);
+		if ( (ende > start) && ((ungerade > 0) == (aklasse == PIP_INTERIOR)) ) {
+			VLONG cur=start;
+			while ( (r < (int)rand.size()) && (rand[r].second < cur) ) r++;
+			for(int r2=r;( (r2 < (int)rand.size()) && (rand[r2].first < ende) );r2++) {
+				if (rand[r2].first > cur) scanEmit(aiv,cur,(VLONG)rand[r2].first-1);
+				if ( ((VLONG)rand[r2].second+1) > cur) cur=(VLONG)rand[r2].second+1;
+			}
+			scanEmit(aiv,cur,ende-1);
+		}
+		start=ende;
+		while ( (j<ne) && (events[j] <= start) ) j++;
+	}
+
+	if (aklasse == PIP_EXTERIOR) scanEmit(aiv,(VLONG)pg->xmax+1,SCANUNENDLICH);
+}
+
+int ScanPolygon::classify(const int ax,const int ay) {
+	// single grid point from the row classification
+	std::vector<VLONG> iv;
+	ScanSweep sw;
+	for(int k=0;k<2;k++) {
+		int klasse=( (k == 0) ? PIP_INTERIOR : PIP_EXTERIOR );
+		row(sw,ay,klasse,iv);
+		for(int m=0;m<(int)iv.size();m+=2) {
+			if ( (iv[m] <= ax) && (ax <= iv[m+1]) ) return klasse;
+		}
+	}
+
+	return PIP_BOUNDARY;
+}
+
+
+// struct ScanSet
+
+int ScanSet::init(Polygon* aintp,const int aintpcount,Polygon* aextp,const int aextpcount) {
+	// 0 if the polygons do not share one denominator
+	nenner=0;
+	for(int k=0;k<(aintpcount+aextpcount);k++) {
+		Polygon& pg=( (k<aintpcount) ? aintp[k] : aextp[k-aintpcount] );
+		if ( (k >= aintpcount) && (pg.pointcount <= 0) ) continue;
+		if (nenner == 0) nenner=pg.nenner;
+		else if (pg.nenner != nenner) return 0;
+	}
+	if (nenner == 0) nenner=1;
+
+	intsp.resize(aintpcount);
+	for(int i=0;i<aintpcount;i++) intsp[i].init(&aintp[i]);
+	extsp.clear();
+	for(int i=0;i<aextpcount;i++) if (aextp[i].pointcount>0) {
+		extsp.push_back(ScanPolygon());
+		extsp.back().init(&aextp[i]);
+	}
+
+	return 1;
+}
+
+
+// struct ScanCursor
+
+ScanCursor::ScanCursor(ScanSet* aset) {
+	set=aset;
+	intsw.resize(set->intsp.size());
+	extsw.resize(set->extsp.size());
+}
+
+int ScanCursor::stencil(ScanPolygon& asp,ScanSweep& asw,const int aklasse,const int acy,std::vector<VLONG>& aiv) {
+	// stencil centres px in row acy whose 5x5 neighbourhood
+	// is completely aklasse: intersection over the five
+	// rows of their intervals shrunk by 2 on both sides
+	aiv.clear();
+	for(int dy=-2;dy<=2;dy++) {
+		asp.row(asw,acy+dy,aklasse,iv);
+		iv2.clear();
+		for(int m=0;m<(int)iv.size();m+=2) {
+			if ( (iv[m]+2) <= (iv[m+1]-2) ) {
+				iv2.push_back(iv[m]+2);
+				iv2.push_back(iv[m+1]-2);
+			}
+		}
+		if (dy == -2) {
+			aiv.swap(iv2);
+		} else {
+			schnitt.clear();
+			int a=0,b=0;
+			while ( (a < (int)aiv.size()) && (b < (int)iv2.size()) ) {
+				VLONG lo=( (aiv[a] > iv2[b]) ? aiv[a] : iv2[b] );
+				VLONG hi=( (aiv[a+1] < iv2[b+1]) ? aiv[a+1] : iv2[b+1] );
+				if (lo <= hi) {
+					schnitt.push_back(lo);
+					schnitt.push_back(hi);
+				}
+				if (aiv[a+1] < iv2[b+1]) a+=2; else b+=2;
+			}
+			aiv.swap(schnitt);
+		}
+		if (aiv.size() == 0) return 0;
+	}
+
+	return 1;
+}
+
+void ScanCursor::classifyRow(
+	const double ay,
+	const int* agx,const int aanz,
+	BYTE* aintin,BYTE* aextout
+) {
+	// agx: grid x of the anz pixel positions, non-decreasing
+	// aintin[k]=1: jsoracleWith with interior polygons only is INTERIOR
+	// aextout[k]=1: jsoracleWith with exterior polygons only is EXTERIOR
+	int cy=(int)floor(ay*set->nenner);
+	std::vector<ScanPolygon>& intsp=set->intsp;
+	std::vector<ScanPolygon>& extsp=set->extsp;
+	dint.assign(aanz+1,0);
+	dext.assign(aanz+1,0);
+
+	for(int i=0;i<(int)intsp.size();i++) {
+		Polygon& pg=*intsp[i].pg;
+		// a stencil row outside the bounding box is exterior
+		if ( ((cy-2) < pg.ymin) || ((cy+2) > pg.ymax) ) continue;
+		if (stencil(intsp[i],intsw[i],PIP_INTERIOR,cy,treffer) <= 0) continue;
+		for(int m=0;m<(int)treffer.size();m+=2) {
+			int lo=(int)(std::lower_bound(agx,agx+aanz,treffer[m])-agx);
+			int hi=(int)(std::upper_bound(agx,agx+aanz,treffer[m+1])-agx);
+			if (lo < hi) {
+				dint[lo]++;
+				dint[hi]--;
+			}
+		}
+	}
+
+	int immer=0;
+	for(int i=0;i<(int)extsp.size();i++) {
+		Polygon& pg=*extsp[i].pg;
+		if ( ((cy+2) < pg.ymin) || ((cy-2) > pg.ymax) ) {
+			immer++;
+			continue;
+		}
+		if (stencil(extsp[i],extsw[i],PIP_EXTERIOR,cy,treffer) <= 0) continue;
+		for(int m=0;m<(int)treffer.size();m+=2) {
+			int lo=(int)(std::lower_bound(agx,agx+aanz,treffer[m])-agx);
+			int hi=(int)(std::upper_bound(agx,agx+aanz,treffer[m+1])-agx);
+			if (lo < hi) {
+				dext[lo]++;
+				dext[hi]--;
+			}
+		}
+	}
+
+	int si=0,se=immer;
+	int anzext=(int)extsp.size();
+	for(int k=0;k<aanz;k++) {
+		si += dint[k];
+		se += dext[k];
+		aintin[k]=( (si > 0) ? 1 : 0 );
+		aextout[k]=( ( (anzext > 0) && (se == anzext) ) ? 1 : 0 );
+	}
+}
+
+void Polygon::unPrepareY(void) {
+	useprepare=0;
+}
+
+void Polygon::add(const int ax,const int ay) {
+	// adds and checks directly for colinear segments
+	
+	if (pointcount > (memused-8)) {
+		// memory is getting filled => allocate bigger part
+
+		int mem2=memused+16384;
+		PolygonPoint *p2=new PolygonPoint[mem2];
+		for(int i=0;i<pointcount;i++) {
+			p2[i].x=points[i].x;
+			p2[i].y=points[i].y;
+		}
+		delete[] points;
+		points=p2;
+		memused=mem2;
+	}
+	
+	if (pointcount == 0) {
+		xmin=xmax=ax;
+		ymin=ymax=ay;
+	} else {
+		if ( (ax-8) < xmin) xmin=ax-8;
+		if ( (ax+8) > xmax) xmax=ax+8;
+		if ( (ay-8) < ymin) ymin=ay-8;
+		if ( (ay+8) > ymax) ymax=ay+8;
+	}
+	
+	if (pointcount >= 2) {
+		// ...A,B, new point
+		if ( 
+			(ax == points[pointcount-1].x) &&
+			(ax == points[pointcount-2].x)
+		) {
+			// if colinear, then remove B
+			points[pointcount-1].x=ax;
+			points[pointcount-1].y=ay;
+		} else
+		if ( 
+			(ay == points[pointcount-1].y) &&
+			(ay == points[pointcount-2].y)
+		) {
+			points[pointcount-1].x=ax;
+			points[pointcount-1].y=ay;
+		} else {
+			// point added
+			points[pointcount].x=ax;
+			points[pointcount].y=ay;
+			pointcount++;
+		}
+	} else {
+		points[pointcount].x=ax;
+		points[pointcount].y=ay;
+		pointcount++;
 	}
 }
 
@@ -499,10 +1549,14 @@ void Charmap::copyFrom(Charmap& b) {
 		palette[i].B=b.palette[i].B;
 	}
 	
-	VLONG offset=0;
-	for(int y=0;y<ylen;y++) for(int x=0;x<xlen;x++) {
-		cmp[offset]=b.cmp[offset];
-		offset++;
+	if (layout == b.layout) {
+		memcpy(cmp,b.cmp,memused);
+		return;
+	}
+	std::vector<BYTE> z(xlen);
+	for(int y=0;y<ylen;y++) {
+		b.getRow(y,0,xlen-1,&z[0]);
+		setRow(y,0,xlen-1,&z[0]);
 	}
 }
 
@@ -511,7 +1565,16 @@ void Charmap::setlenxy(const int ax,const int ay) {
 	
 	xlen=ax;
 	ylen=ay;
-	memused=xlen*ylen;
+	layout=charmaplayout;
+	if (layout == LAYOUT_TILED) {
+		// whole tiles, the last ones partly unused
+		tilesx=(xlen+CHARMAPTILE-1) >> CHARMAPTILESHIFT;
+		VLONG tilesy=(ylen+CHARMAPTILE-1) >> CHARMAPTILESHIFT;
+		memused=(tilesx*tilesy) << (2*CHARMAPTILESHIFT);
+	} else {
+		tilesx=0;
+		memused=xlen*ylen;
+	}
 	cmp=new BYTE[memused];
 	if (!cmp) {
 		LOGMSG("\nMemory error Charmap.\n");
@@ -523,6 +1586,8 @@ Charmap::Charmap() {
 	xlen=ylen=0;
 	memused=0;
 	cmp=NULL;
+	layout=LAYOUT_ROWS;
+	tilesx=0;
 }
 
 Charmap::~Charmap() {
@@ -541,14 +1606,197 @@ void Charmap::setPaletteRGB(const int pos,const BYTE ar,const BYTE ag,const BYTE
 	palette[pos].B=ab;
 }
 
+VLONG Charmap::offset(const int ax,const int ay) {
+	if (layout == LAYOUT_ROWS) return (VLONG)ay*xlen+ax;
+	VLONG tile=(VLONG)(ay >> CHARMAPTILESHIFT)*tilesx + (ax >> CHARMAPTILESHIFT);
+	return (tile << (2*CHARMAPTILESHIFT))
+		+ ((ay & (CHARMAPTILE-1)) << CHARMAPTILESHIFT)
+		+ (ax & (CHARMAPTILE-1));
+}
+
 void Charmap::setPoint(const int ax,const int ay,const BYTE awert) {
-	VLONG pos=(VLONG)ay*xlen+ax;
-	cmp[pos]=awert;
+	cmp[offset(ax,ay)]=awert;
 }
 
 BYTE Charmap::getPoint(const int ax,const int ay) {
-	VLONG pos=(VLONG)ay*xlen+ax;
-	return cmp[pos];
+	return cmp[offset(ax,ay)];
+}
+
+void Charmap::getRow(const int ay,const int ax0,const int ax1,BYTE* ziel) {
+	// pixels ax0..ax1 of row ay, in row order whatever the layout
+	int x=ax0;
+	while (x <= ax1) {
+		int n=( (layout == LAYOUT_ROWS) ? ax1-x+1 :
+			minimumI(ax1-x+1,CHARMAPTILE-(x & (CHARMAPTILE-1))) );
+		memcpy(ziel,&cmp[offset(x,ay)],n);
+		ziel += n;
+		x += n;
+	}
+}
+
+void Charmap::setRow(const int ay,const int ax0,const int ax1,const BYTE* quelle) {
+	int x=ax0;
+	while (x <= ax1) {
+		int n=( (layout == LAYOUT_ROWS) ? ax1-x+1 :
+			minimumI(ax1-x+1,CHARMAPTILE-(x & (CHARMAPTILE-1))) );
+		memcpy(&cmp[offset(x,ay)],quelle,n);
+		quelle += n;
+		x += n;
+	}
+}
+
+
+// struct CharmapCursor
+
+void CharmapCursor::setTo(Charmap& amap,const int ax,const int ay) {
+	map=&amap;
+	x=ax;
+	y=ay;
+	p=&amap.cmp[amap.offset(ax,ay)];
+	zeile=( (amap.layout == LAYOUT_ROWS) ? amap.xlen : CHARMAPTILE );
+}
+
+BYTE CharmapCursor::get(void) {
+	return *p;
+}
+
+void CharmapCursor::set(const BYTE awert) {
+	*p=awert;
+}
+
+void CharmapCursor::right(void) {
+	x++;
+	if ( (map->layout == LAYOUT_ROWS) || ((x & (CHARMAPTILE-1)) != 0) ) p++;
+	else p=&map->cmp[map->offset(x,y)];
+}
+
+void CharmapCursor::down(void) {
+	y++;
+	if ( (map->layout == LAYOUT_ROWS) || ((y & (CHARMAPTILE-1)) != 0) ) p += zeile;
+	else p=&map->cmp[map->offset(x,y)];
+}
+
+BYTE CharmapCursor::at(const int dx,const int dy) {
+	// dx,dy in -1..1
+	if (map->layout == LAYOUT_TILED) {
+		int ix=(x & (CHARMAPTILE-1)) + dx;
+		int iy=(y & (CHARMAPTILE-1)) + dy;
+		if ( (ix < 0) || (ix >= CHARMAPTILE) || (iy < 0) || (iy >= CHARMAPTILE) ) {
+			return map->getPoint(x+dx,y+dy);
+		}
+	}
+	return p[dy*zeile+dx];
+}
+
+
+// struct Bitplane
+
+void Bitplane::setlenxy(const int ax,const int ay) {
+	xlen=ax;
+	ylen=ay;
+	wpr=(ax+63) >> 6;
+	bits.assign((VLONG)wpr*ay,0);
+}
+
+unsigned long long* Bitplane::row(const int ay) {
+	return &bits[(VLONG)ay*wpr];
+}
+
+int Bitplane::get(const int ax,const int ay) {
+	return (int)( (bits[(VLONG)ay*wpr+(ax >> 6)] >> (ax & 63)) & 1 );
+}
+
+void Bitplane::set(const int ax,const int ay) {
+	bits[(VLONG)ay*wpr+(ax >> 6)] |= (1ULL << (ax & 63));
+}
+
+void Bitplane::clear(const int ax,const int ay) {
+	bits[(VLONG)ay*wpr+(ax >> 6)] &= ~(1ULL << (ax & 63));
+}
+
+void Bitplane::setRange(const int ay,const int ax0,const int ax1) {
+	// pixels ax0..ax1 of row ay
+	if (ax0 > ax1) return;
+	unsigned long long* r=row(ay);
+	int w0=ax0 >> 6,w1=ax1 >> 6;
+	unsigned long long m0=~0ULL << (ax0 & 63);
+	unsigned long long m1=~0ULL >> (63-(ax1 & 63));
+	if (w0 == w1) {
+		r[w0] |= (m0 & m1);
+		return;
+	}
+	r[w0] |= m0;
+	for(int w=w0+1;w<w1;w++) r[w]=~0ULL;
+	r[w1] |= m1;
+}
+
+int Bitplane::nextSet(const int ay,const int ax,const int ax1) {
+	// lowest set pixel in ax..ax1 of row ay, -1 if none
+	if ( (ax > ax1) || (ax >= xlen) ) return -1;
+	unsigned long long* r=row(ay);
+	int w=ax >> 6;
+	int w1=minimumI(ax1,xlen-1) >> 6;
+	unsigned long long v=r[w] & (~0ULL << (ax & 63));
+	while (1) {
+		if (v != 0) {
+			int x=(w << 6) + lowestBit(v);
+			return (x <= ax1) ? x : -1;
+		}
+		if (++w > w1) return -1;
+		v=r[w];
+	}
+}
+
+
+// struct FloodPlanes
+
+void FloodPlanes::boundary(Bitplane& ziel) {
+	// marked pixels with a relf pixel among their 8
+	// neighbours, rows and columns 1..len-2 (the blue ones):
+	// frei widened by one pixel to both sides, ORed over
+	// three rows, ANDed with aktiv
+	int wpr=frei.wpr;
+	ziel.setlenxy(frei.xlen,frei.ylen);
+	if ( (frei.xlen < 3) || (frei.ylen < 3) ) return;
+	std::vector<unsigned long long> breit[3],tmp(wpr),maske(wpr,0);
+	for(int x=1;x<(frei.xlen-1);x++) maske[x >> 6] |= (1ULL << (x & 63));
+	auto verbreitern=[&](const int y,std::vector<unsigned long long>& b) {
+		b.resize(wpr);
+		unsigned long long* f=frei.row(y);
+		for(int w=0;w<wpr;w++) b[w]=f[w];
+		bitsShift(f,&tmp[0],wpr,1);
+		for(int w=0;w<wpr;w++) b[w] |= tmp[w];
+		bitsShift(f,&tmp[0],wpr,-1);
+		for(int w=0;w<wpr;w++) b[w] |= tmp[w];
+	};
+	verbreitern(0,breit[0]);
+	verbreitern(1,breit[1]);
+	for(int y=1;y<(frei.ylen-1);y++) {
+		verbreitern(y+1,breit[(y+1) % 3]);
+		unsigned long long* a=aktiv.row(y);
+		unsigned long long* z=ziel.row(y);
+		for(int w=0;w<wpr;w++) {
+			z[w]=a[w] & maske[w] & (breit[0][w] | breit[1][w] | breit[2][w]);
+		}
+	}
+}
+
+void FloodPlanes::render(Charmap& md) {
+	// the byte image the planes stand for, for error
+	// images: the input, marked pixels in AKTIVCOL, boundary
+	// pixels blue, those already used by a polygon yellow
+	md.setlenxy(inbild.xlen,inbild.ylen);
+	setPaletteTo(md);
+	md.copyFrom(inbild);
+	Bitplane rand;
+	boundary(rand);
+	for(int y=0;y<inbild.ylen;y++) {
+		for(int x=0;x<inbild.xlen;x++) {
+			if (aktiv.get(x,y) <= 0) continue;
+			if (rand.get(x,y) <= 0) md.setPoint(x,y,AKTIVCOL);
+			else md.setPoint(x,y,(blau.get(x,y) > 0) ? COLORBLUE : COLORYELLOW);
+		}
+	}
 }
 
 void Charmap::lineVH(const int aax,const int aay,const int bbx,const int bby,const BYTE awert) {
@@ -567,17 +1815,21 @@ void Charmap::lineVH(const int aax,const int aay,const int bbx,const int bby,con
 		// vertical
 		int y0,y1;
 		if (ay < by) { y0=ay; y1=by; } else { y0=by; y1=ay; }
+		CharmapCursor c;
+		c.setTo(*this,ax,y0);
 		for(int y=y0;y<=y1;y++) {
-			VLONG pos=y*(VLONG)xlen+ax;
-			cmp[pos]=awert;
+			c.set(awert);
+			if (y < y1) c.down();
 		} // y
 	} else if (ay == by) {
 		// horizontal
 		int x0,x1;
 		if (ax < bx) { x0=ax; x1=bx; } else { x0=bx; x1=ax; }
+		CharmapCursor c;
+		c.setTo(*this,x0,ay);
 		for(int x=x0;x<=x1;x++) {
-			VLONG pos=ay*(VLONG)xlen+x;
-			cmp[pos]=awert;
+			c.set(awert);
+			if (x < x1) c.right();
 		} // y
 	} 
 	
@@ -642,7 +1894,14 @@ void Charmap::saveAsBmp(const char* afn) {
 		fwrite(puffer,4,sizeof(BYTE),fbmp);
 	}
 	
-	fwrite(cmp,memused,sizeof(BYTE),fbmp);
+	if (layout == LAYOUT_ROWS) fwrite(cmp,memused,sizeof(BYTE),fbmp);
+	else {
+		std::vector<BYTE> z(xlen);
+		for(int y=0;y<ylen;y++) {
+			getRow(y,0,xlen-1,&z[0]);
+			fwrite(&z[0],xlen,sizeof(BYTE),fbmp);
+		}
+	}
 
 	fclose(fbmp);	
 }
@@ -697,7 +1956,14 @@ int Charmap::loadAsBmp(const char* afn) {
 		palette[i].R=puffer[2];
 	}
 	
-	fread(cmp,memused,sizeof(BYTE),fbmp);
+	if (layout == LAYOUT_ROWS) fread(cmp,memused,sizeof(BYTE),fbmp);
+	else {
+		std::vector<BYTE> z(xlen);
+		for(int y=0;y<ylen;y++) {
+			fread(&z[0],xlen,sizeof(BYTE),fbmp);
+			setRow(y,0,xlen-1,&z[0]);
+		}
+	}
 
 	fclose(fbmp);
 	
@@ -777,7 +2043,7 @@ void drawCrossing(Charmap* inout,const int ax,const int ay,const BYTE af) {
 int interiorPolygon(void) {
 	// find interior regions and connect them
 	// with space to the surrounding
-	Charmap *blau=floodFillPattern(COLORBLACK);
+	FloodPlanes *blau=floodFillPattern(COLORBLACK);
 	
 	// find polygons and save them
 	int erg=buildPolygon(blau,"int");
@@ -790,7 +2056,7 @@ int interiorPolygon(void) {
 // pattern-driven flood fill and connecting those
 // within true interior or exterior as needed
 
-Charmap* floodFillPattern(const int relf) {
+FloodPlanes* floodFillPattern(const int relf) {
 	// look for GRANULARITYxGRANULARITY pattern of identical color
 	// (black or white), mark the inner part leaving
 	// one pixel at the circumference
@@ -801,101 +2067,210 @@ Charmap* floodFillPattern(const int relf) {
 	// then those marked pixels which have as neighbour
 	// at least one black or white (depending on what
 	// type of polygon one is looking for) encompass the boundary
+	// The image is held in bit planes (FloodPlanes), 64 pixels
+	// per word. Gray pixels are read from inbild, they do not
+	// change before the border is filled at the very end
+
+	int xlen=inbild.xlen;
+	int ylen=inbild.ylen;
+	FloodPlanes* fl=new FloodPlanes;
+	fl->relf=relf;
+	Bitplane& frei=fl->frei;
+	Bitplane& aktiv=fl->aktiv;
+	frei.setlenxy(xlen,ylen);
+	aktiv.setlenxy(xlen,ylen);
+	std::vector<BYTE> z(xlen);
+	for(int y=0;y<ylen;y++) {
+		inbild.getRow(y,0,xlen-1,&z[0]);
+		for(int x=0;x<xlen;x++) {
+			if (z[x] == relf) frei.set(x,y);
+		}
+	}
+	int wpr=frei.wpr;
+	std::vector<unsigned long long> t1(wpr),t2(wpr),t3(wpr);
 
-	Charmap *ptsa=new Charmap;
-	ptsa->setlenxy(inbild.xlen,inbild.ylen);
-	setPaletteTo(*ptsa);
-	ptsa->copyFrom(inbild);
-	
 	if (granularity < 3) granularity=3;
 	int D=granularity;
+	// the connect rule below bridges exactly the two pixel gap
+	// between the seeds of blocks lying side by side, so the
+	// blocks can be shifted but not spaced differently
+	if ( (kernelstride > 0) && (kernelstride != D) ) {
+		LOGMSG3("\nERROR. KERNELSTRIDE=%i must equal GRANULARITY=%i.\n",kernelstride,D);
+		exit(99);
+	}
 	printf("\nsearching for kernel points ...");
-	for(int y=0;y<(inbild.ylen-D);y+=D) {
-		for(int x=0;x<(inbild.xlen-D);x+=D) {
-			if (ptsa->getPoint(x,y) != relf) continue;
-				
-			int gef=1;
-			for(int dy=0;dy<D;dy++) {
-				for(int dx=0;dx<D;dx++) {
-					if (ptsa->getPoint(x+dx,y+dy) != relf) {
-						gef=0;
-						break;
-					}
-				} // dx
-				if (gef <= 0) break;
-			} // dy
-				
-			if (gef <= 0) continue;
-				
+	// blocks side by side, the first at kerneloffset.
+	// A block is a kernel if all its D*D pixels are relf: the
+	// D rows of a block row ANDed give the columns that are
+	// relf throughout, bit x of that ANDed with its shifts
+	// by 1, 2, 4, ... pixels tells whether columns x..x+D-1
+	// all are
+	for(int y=kerneloffset;y<(ylen-D);y+=D) {
+		for(int w=0;w<wpr;w++) t1[w]=~0ULL;
+		for(int dy=0;dy<D;dy++) {
+			unsigned long long* f=frei.row(y+dy);
+			for(int w=0;w<wpr;w++) t1[w] &= f[w];
+		}
+		int len=1;
+		while ( (len << 1) <= D ) {
+			bitsShift(&t1[0],&t2[0],wpr,len);
+			for(int w=0;w<wpr;w++) t1[w] &= t2[w];
+			len <<= 1;
+		}
+		if (len < D) {
+			bitsShift(&t1[0],&t2[0],wpr,D-len);
+			for(int w=0;w<wpr;w++) t1[w] &= t2[w];
+		}
+
+		for(int x=kerneloffset;x<(xlen-D);x+=D) {
+			if ( ((t1[x >> 6] >> (x & 63)) & 1) == 0) continue;
+
 			// leave border rectangle unchanged
-			for(int y2=(y+1);y2<(y+D-1);y2++) {
-				for(int x2=(x+1);x2<(x+D-1);x2++) {
-					ptsa->setPoint(x2,y2,AKTIVCOL);
-				}
-			}
-				
+			for(int y2=(y+1);y2<(y+D-1);y2++) aktiv.setRange(y2,x+1,x+D-2);
 		} // x
 	} // y
+	for(VLONG i=0;i<(VLONG)frei.bits.size();i++) frei.bits[i] &= ~aktiv.bits[i];
 	
 	// connect the patterns of AKTIVCOLOR
-	int changed=1;
+	// the result depends on the order in which connections
+	// are made (a pixel set by one blocks an overlapping
+	// other), so the raster passes are kept: every pass
+	// goes through the pixels in raster order, seeing the
+	// changes made before in the same pass. But a pixel is
+	// only looked at again if one of the pixels its rule
+	// reads changed since: ahead of the current position
+	// still in this pass, otherwise in the next one. Gray
+	// never changes. Same passes, same result, work per
+	// pass proportional to the changes
+	auto versuch=[&](const int x,const int y) {
+		if (frei.get(x,y) <= 0) return 0;
+
+		if (
+			(frei.get(x+1,y) > 0) &&
+			(aktiv.get(x-1,y) > 0) &&
+			(aktiv.get(x+2,y) > 0)
+		) {
+			// two horizontal black pixels with adjacent AKTIVCOL ones
+			// line part above and below must be GRAY-free
+			CharmapCursor c;
+			c.setTo(inbild,x,y);
+			for(int dx=0;dx<4;dx++) {
+				if (
+					(c.at(0,-1) == COLORGRAY) ||
+					(c.at(0,1) == COLORGRAY)
+				) return 0;
+				if (dx < 3) c.right();
+			}
+
+			// set the black pixels to AKTIVCOL as well to establish the connection
+			aktiv.set(x,y);
+			aktiv.set(x+1,y);
+			frei.clear(x,y);
+			frei.clear(x+1,y);
+			return 1;
+		} // gray active active gray
+		else if (
+			(frei.get(x,y+1) > 0) &&
+			(aktiv.get(x,y+2) > 0) &&
+			(aktiv.get(x,y-1) > 0)
+		) {
+			// same in vertical connection
+			CharmapCursor c;
+			c.setTo(inbild,x,y);
+			for(int dy=0;dy<4;dy++) {
+				if (
+					(c.at(-1,0) == COLORGRAY) ||
+					(c.at(1,0) == COLORGRAY)
+				) return 0;
+				if (dy < 3) c.down();
+			}
+
+			aktiv.set(x,y);
+			aktiv.set(x,y+1);
+			frei.clear(x,y);
+			frei.clear(x,y+1);
+			return 2;
+		}
+
+		return 0;
+	};
+
+	// pixel (x,y) reads (x-1..x+2,y) and (x,y-1..y+2), so a
+	// change at q concerns q itself, q-1, q-2, q+1 in its row
+	// and in its column the rows qy-2, qy-1, qy+1. Those get
+	// marked, per row with the span of marked pixels. A row
+	// not yet reached is done in this pass, the part of the
+	// current row ahead of x as well, all else in the next.
+	// At the start only the pixels whose rule holds apart from
+	// the gray test are marked, word by word: a pixel whose
+	// rule does not hold can only fire after a change nearby
+	Bitplane markiert;
+	markiert.setlenxy(xlen,ylen);
+	std::vector<int> rlo(ylen,0x7FFFFFFF),rhi(ylen,-1);
+	if (xlen >= 4) {
+		std::vector<unsigned long long> maske(wpr,0);
+		for(int x=1;x<(xlen-2);x++) maske[x >> 6] |= (1ULL << (x & 63));
+		for(int y=1;y<(ylen-2);y++) {
+			unsigned long long* f=frei.row(y);
+			unsigned long long* f1=frei.row(y+1);
+			unsigned long long* aa=aktiv.row(y-1);
+			unsigned long long* a2=aktiv.row(y+2);
+			bitsShift(f,&t1[0],wpr,1);
+			bitsShift(aktiv.row(y),&t2[0],wpr,-1);
+			bitsShift(aktiv.row(y),&t3[0],wpr,2);
+			unsigned long long* m=markiert.row(y);
+			int gef=0;
+			for(int w=0;w<wpr;w++) {
+				unsigned long long h=t1[w] & t2[w] & t3[w];
+				unsigned long long v=f1[w] & aa[w] & a2[w];
+				m[w]=f[w] & (h | v) & maske[w];
+				if (m[w] != 0) gef=1;
+			}
+			if (gef > 0) {
+				rlo[y]=1;
+				rhi[y]=xlen-3;
+			}
+		}
+	}
+	int cx=0,cy=0,hi=0;
+	auto markieren=[&](const int qx,const int qy) {
+		const int DX[7]={-1,0,1,2,0,0,0};
+		const int DY[7]={0,0,0,0,-1,1,2};
+		for(int k=0;k<7;k++) {
+			int x=qx-DX[k];
+			int y=qy-DY[k];
+			if ( (x < 1) || (x >= (xlen-2)) || (y < 1) || (y >= (ylen-2)) ) continue;
+			markiert.set(x,y);
+			if ( (y == cy) && (x > cx) ) {
+				if (x > hi) hi=x;
+			} else {
+				if (x < rlo[y]) rlo[y]=x;
+				if (x > rhi[y]) rhi[y]=x;
+			}
+		}
+	};
+
 	printf("\nconnecting snippets ");
+	int changed=1;
 	while (changed>0) {
 		printf(".");
 		changed=0;
-		for(int y=1;y<(ptsa->ylen-2);y++) {
-			for(int x=1;x<(ptsa->xlen-2);x++) {
-				if (ptsa->getPoint(x,y) != relf) continue;
-			
-				if (
-					(ptsa->getPoint(x+1,y) == relf) &&
-					(ptsa->getPoint(x-1,y) == AKTIVCOL) &&
-					(ptsa->getPoint(x+2,y) == AKTIVCOL)
-				) {
-					// two horizontal black pixels with adjacent AKTIVCOL ones
-					// line part above and below must be GRAY-free
-					int korrekt=1;
-					for(int dx=0;dx<4;dx++) {
-						if (
-							(ptsa->getPoint(x+dx,y-1) == COLORGRAY) ||
-							(ptsa->getPoint(x+dx,y+1) == COLORGRAY)
-						) {
-							korrekt=0;
-							break;
-						}
-					}
-				
-					if (korrekt>0) {
-						// set the black pixels to AKTIVCOL as well to establish the connection
-						ptsa->setPoint(x,y,AKTIVCOL);
-						ptsa->setPoint(x+1,y,AKTIVCOL);
-						changed=1;
-					}
-				} // gray active active gray
-				else if (
-					(ptsa->getPoint(x,y+1) == relf) &&
-					(ptsa->getPoint(x,y+2) == AKTIVCOL) &&
-					(ptsa->getPoint(x,y-1) == AKTIVCOL)
-				) {
-					// same in vertical connection
-					int korrekt=1;
-					for(int dy=0;dy<4;dy++) {
-						if (
-							(ptsa->getPoint(x-1,y+dy) == COLORGRAY) ||
-							(ptsa->getPoint(x+1,y+dy) == COLORGRAY)
-						) {
-							korrekt=0;
-							break;
-						}
-					}
-				
-					if (korrekt>0) {
-						ptsa->setPoint(x,y,AKTIVCOL);
-						ptsa->setPoint(x,y+1,AKTIVCOL);
-						changed=1;
-					}
-
-				} 
+		for(cy=1;cy<(ylen-2);cy++) {
+			if (rhi[cy] < rlo[cy]) continue;
+			cx=rlo[cy];
+			hi=rhi[cy];
+			rlo[cy]=0x7FFFFFFF;
+			rhi[cy]=-1;
+			while ( (cx=markiert.nextSet(cy,cx,hi)) >= 0) {
+				markiert.clear(cx,cy);
+				int art=versuch(cx,cy);
+				if (art > 0) {
+					changed=1;
+					markieren(cx,cy);
+					if (art == 1) markieren(cx+1,cy);
+					else markieren(cx,cy+1);
+				}
+				cx++;
 			} // x
 		} // y
 	} // while changed
@@ -904,51 +2279,37 @@ Charmap* floodFillPattern(const int relf) {
 	// screen border per requirement on
 	// the image having BORDERWIDTH 
 	if (relf == COLORWHITE) {
-		ptsa->fillrect(0,0,ptsa->xlen-1,BORDERWIDTH-1,AKTIVCOL);
-		ptsa->fillrect(0,ptsa->ylen-1-(BORDERWIDTH-1),ptsa->xlen-1,ptsa->ylen-1,AKTIVCOL);
-		ptsa->fillrect(0,0,BORDERWIDTH-1,ptsa->ylen-1,AKTIVCOL);
-		ptsa->fillrect(ptsa->xlen-1-(BORDERWIDTH-1),0,ptsa->xlen-1,ptsa->ylen-1,AKTIVCOL);
+		for(int y=0;y<ylen;y++) {
+			if ( (y < BORDERWIDTH) || (y > (ylen-1-BORDERWIDTH)) ) aktiv.setRange(y,0,xlen-1);
+			else {
+				aktiv.setRange(y,0,BORDERWIDTH-1);
+				aktiv.setRange(y,xlen-BORDERWIDTH,xlen-1);
+			}
+		}
+		for(VLONG i=0;i<(VLONG)frei.bits.size();i++) frei.bits[i] &= ~aktiv.bits[i];
 	}
 	
 	// boundary are those AKTIVCOL pixles with at least
 	// one neighbour of RELF color
 	printf("\nsearching for boundaries ...");
-	
-	for(int y=1;y<(ptsa->ylen-1);y++) {
-		for(int x=1;x<(ptsa->xlen-1);x++) {
-			if (ptsa->getPoint(x,y) != AKTIVCOL) continue;
-			
-			int gef=0;
-			for(int dy=-1;dy<=1;dy++) {
-				for(int dx=-1;dx<=1;dx++) {
-					if (ptsa->getPoint(x+dx,y+dy) == relf) {
-						gef=1;
-						break;
-					}
-				}
-				if (gef>0) break;
-			}
-			
-			if (gef<=0) continue;
-			
-			ptsa->setPoint(x,y,COLORBLUE);
-		} // x
-	} // y
+	fl->boundary(fl->blau);
 	
 	// now the blue pixels constitute all the (to be found) polygons
 
-	return ptsa;
+	return fl;
 }
 
-int buildPolygon(Charmap* blau,const char* afnpref) {
+int buildPolygon(FloodPlanes* fl,const char* afnpref) {
 	// looking repeatedly for blue pixels and following
 	// them. By construction there should only ever be
 	// two adjacent blue pixels to one blue pixel. So
 	// the walking direction is determined (except for the first point in a polygon).
 	
 	VLONG NENNER=( (VLONG)1 << 25);
-	int polanz=0;
-	char tmp[1024];
+	int polanz=0,dropped=0;
+	char tmp[2048];
+	
+	if (symmetry != SYM_NONE) saveSymmetry(polypath,symmetry);
 	
 	#define POLYGONADD(XX,YY) \
 	{\
@@ -959,6 +2320,10 @@ int buildPolygon(Charmap* blau,const char* afnpref) {
 	
 	printf("\nsearching for polygons ");
 
+	// blue pixels only ever get used up, so the search for
+	// the next starting point goes on where the last one was
+	Bitplane& blau=fl->blau;
+	int suchy=0;
 	int changed=1;
 	while (changed>0) {
 		changed=0;
@@ -967,15 +2332,13 @@ int buildPolygon(Charmap* blau,const char* afnpref) {
 		int startx=-1,starty=-1;
 		
 		// find an unused blue starting point of a polygon
-		for(int y=0;y<blau->ylen;y++) {
-			for(int x=0;x<blau->xlen;x++) {
-				if (blau->getPoint(x,y) == COLORBLUE) {
-					startx=x;
-					starty=y;
-					break;
-				}
+		for(;suchy<blau.ylen;suchy++) {
+			int x=blau.nextSet(suchy,0,blau.xlen-1);
+			if (x >= 0) {
+				startx=x;
+				starty=suchy;
+				break;
 			}
-			if (startx>=0) break;
 		}
 		
 		if (startx < 0) {
@@ -988,34 +2351,34 @@ int buildPolygon(Charmap* blau,const char* afnpref) {
 		// starting point has two unused blue neighbours
 		// choose arbitrarily one to establish the direction
 		int nx=-1,ny=-1,aktx=startx,akty=starty;
-		if (blau->getPoint(aktx+1,akty) == COLORBLUE) {
+		if (blau.get(aktx+1,akty) > 0) {
 			nx=aktx+1;
 			ny=akty;
 		} else
-		if (blau->getPoint(aktx-1,akty) == COLORBLUE) {
+		if (blau.get(aktx-1,akty) > 0) {
 			nx=aktx-1;
 			ny=akty;
 		} else
-		if (blau->getPoint(aktx,akty-1) == COLORBLUE) {
+		if (blau.get(aktx,akty-1) > 0) {
 			nx=aktx;
 			ny=akty-1;
 		} else
-		if (blau->getPoint(aktx,akty+1) == COLORBLUE) {
+		if (blau.get(aktx,akty+1) > 0) {
 			nx=aktx;
 			ny=akty+1;
 		} else {
 			// one blue point surrounded by nothing
 			// remove
-			blau->setPoint(startx,starty,COLORYELLOW);
+			blau.clear(startx,starty);
 			continue; 
 		}
 		
 		Polygon* p1=new Polygon;
-		p1->setlen(blau->xlen << 4);
+		p1->setlen(blau.xlen << 4);
 		p1->nenner=NENNER;
 		p1->cx0=p1->cy0=RANGE0;
 		p1->cx1=p1->cy1=RANGE1;
-		blau->setPoint(nx,ny,COLORYELLOW);
+		blau.clear(nx,ny);
 		POLYGONADD(startx,starty);
 		POLYGONADD(nx,ny);
 		
@@ -1032,34 +2395,36 @@ int buildPolygon(Charmap* blau,const char* afnpref) {
 			}
 			
 			nx=ny=-1;
-			if (blau->getPoint(aktx+1,akty) == COLORBLUE) {
+			if (blau.get(aktx+1,akty) > 0) {
 				nx=aktx+1;
 				ny=akty;
 			} else
-			if (blau->getPoint(aktx-1,akty) == COLORBLUE) {
+			if (blau.get(aktx-1,akty) > 0) {
 				nx=aktx-1;
 				ny=akty;
 			} else
-			if (blau->getPoint(aktx,akty-1) == COLORBLUE) {
+			if (blau.get(aktx,akty-1) > 0) {
 				nx=aktx;
 				ny=akty-1;
 			} else
-			if (blau->getPoint(aktx,akty+1) == COLORBLUE) {
+			if (blau.get(aktx,akty+1) > 0) {
 				nx=aktx;
 				ny=akty+1;
 			} else {
 				// no further point to follow, but not closed
 				// probably self-loop. Currently unhandled.
 				LOGMSG("\n\nERROR. Polygon not closable. Probably self-loop.\n");
-				drawCrossing(blau,aktx,akty,COLORRED);
-				blau->saveAsBmp("_ERROR_not_closing.bmp");
+				Charmap md;
+				fl->render(md);
+				drawCrossing(&md,aktx,akty,COLORRED);
+				md.saveAsBmp("_ERROR_not_closing.bmp");
 				exit(99);
 				discard=1;
 				break;
 			}
 			
 			// mark next point as visited
-			blau->setPoint(nx,ny,COLORYELLOW);
+			blau.clear(nx,ny);
 			POLYGONADD(nx,ny)
 			aktx=nx;
 			akty=ny;
@@ -1069,8 +2434,17 @@ int buildPolygon(Charmap* blau,const char* afnpref) {
 			// valid poilygon. CHeck for colinearity
 			// over the polygon's end.
 			p1->trimColinearStart();
+			if (
+				(symmetry != SYM_NONE) && 
+				(p1->pointcount > LOWERBOUNDPOLYGONLENGTH) &&
+				(p1->ymax < -2)
+			) {
+				// completely in the lower half plane: no 5x5 stencil
+				// of a folded query (imaginary part >= 0) reaches it
+				dropped++;
+			} else
 			if (p1->pointcount > LOWERBOUNDPOLYGONLENGTH) {
-				sprintf(tmp,"%spoly%04i",afnpref,polanz);
+				sprintf(tmp,"%s%spoly%04i",polypath,afnpref,polanz);
 				printf("possible polygon found with %i vertices: file %s\n",p1->pointcount,tmp);
 				p1->save(tmp);
 				polanz++;
@@ -1080,6 +2454,21 @@ int buildPolygon(Charmap* blau,const char* afnpref) {
 		delete p1;
 	} // while
 	
+	if (dropped>0) {
+		LOGMSG2("\n%i polygons in the lower half plane not stored due to symmetry\n",dropped);
+	}
+	
+	if (bundlefn[0]) {
+		// bundle of all polygons currently present as text files,
+		// i.e. the ones just built and those of the other type
+		loadPolygons(polypath,intp,intpcount,extp,extpcount);
+		symmetry=loadSymmetry(polypath);
+		writeBundle(bundlefn);
+		delete[] intp;
+		delete[] extp;
+		intp=extp=NULL;
+	}
+	
 	return 1;
 }
 
@@ -1092,7 +2481,7 @@ int buildPolygon(Charmap* blau,const char* afnpref) {
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
 int exteriorPolygon(void) {
-	Charmap *blau=floodFillPattern(COLORWHITE);
+	FloodPlanes *blau=floodFillPattern(COLORWHITE);
 	int erg=buildPolygon(blau,"ext");
 	delete blau;
 	
@@ -1117,18 +2506,31 @@ int qcB2(
 	Charmap& md,
 	Polygon& apg,
 	const BYTE relf,
-	const BYTE apolcol
+	const BYTE apolcol,
+	const int areport,
+	QcReport* arep,
+	const int aindex
 ) {
 	// check whether drawn-in polygons touch another
 	// folfow each edge of a polygon and check
 	// its neighbours
+	// areport=0: only the result, md is not changed (used
+	// by the parallel check)
+	// arep: every failing vertex and the first failing pixel
+	// of every edge go to the report (aindex: number of the
+	// polygon over both kinds), md is not changed
+	int erg=1;
+	int ext=( (aindex >= intpcount) ? 1 : 0 );
+	int nr=( (ext > 0) ? aindex-intpcount : aindex );
 	
 	#define COUNTNEIGHBOURS(XX,YY)\
 	{\
+		CharmapCursor nc;\
+		nc.setTo(md,XX,YY);\
 		for(int dy=-1;dy<=1;dy++) {\
 			for(int dx=-1;dx<=1;dx++) {\
 				if ((dx==0)&&(dy==0)) continue;\
-				BYTE f=md.getPoint(XX+dx,YY+dy);\
+				BYTE f=nc.at(dx,dy);\
 				if (f == relf) ctrrelf++;\
 				else if (f== apolcol) ctrapolcol++;\
 				else ctrother++;\
@@ -1147,13 +2549,18 @@ int qcB2(
 		// other 6 have to be relf
 		int ctrrelf,ctrapolcol,ctrother;
 		ctrrelf=ctrapolcol=ctrother=0;
-		COUNTNEIGHBOURS(xx0,yy0)
+		// collecting: the start point is the end point of the
+		// previous edge (closed polygon), checked there
+		if (!arep) COUNTNEIGHBOURS(xx0,yy0)
 		if (
-			(ctrapolcol != 2) || (ctrrelf != 6)
+			(!arep) &&
+			( (ctrapolcol != 2) || (ctrrelf != 6) )
 		) {
-			LOGMSG("ERROR. Vertex wrong neighbours.\n");
-			drawCrossing(&md,xx0,yy0,COLORRED);
-			md.saveAsBmp("_ERROR_vertex.bmp");
+			if (areport > 0) {
+				LOGMSG("ERROR. Vertex wrong neighbours.\n");
+				drawCrossing(&md,xx0,yy0,COLORRED);
+				md.saveAsBmp("_ERROR_vertex.bmp");
+			}
 			return 0;
 		}
 		ctrrelf=ctrapolcol=ctrother=0;
@@ -1161,10 +2568,17 @@ int qcB2(
 		if (
 			(ctrapolcol != 2) || (ctrrelf != 6)
 		) {
-			LOGMSG("ERROR. Vertex wrong neighbours.\n");
-			drawCrossing(&md,xx1,yy1,COLORRED);
-			md.saveAsBmp("_ERROR_vertex.bmp");
-			return 0;
+			if (arep) {
+				arep->add(QCF_VERTEX,ext,nr,xx1,yy1,xx1,yy1);
+				erg=0;
+			} else {
+				if (areport > 0) {
+					LOGMSG("ERROR. Vertex wrong neighbours.\n");
+					drawCrossing(&md,xx1,yy1,COLORRED);
+					md.saveAsBmp("_ERROR_vertex.bmp");
+				}
+				return 0;
+			}
 		}
 
 		if (xx0==xx1) {
@@ -1172,17 +2586,27 @@ int qcB2(
 			int y0,y1;
 			getMinMax(yy0,yy1,y0,y1);
 			
+			CharmapCursor c;
+			c.setTo(md,xx0,y0);
 			for(int y3=(y0+1);y3<=(y1-1);y3++) {
+				c.down();
 				// all points must be apolcol and left and right neighbour relf
 				if (
-					(md.getPoint(xx0-1,y3) == relf) &&
-					(md.getPoint(xx0,y3) == apolcol) &&
-					(md.getPoint(xx0+1,y3) == relf)
+					(c.at(-1,0) == relf) &&
+					(c.get() == apolcol) &&
+					(c.at(1,0) == relf)
 				) continue;
 				else {
-					LOGMSG("ERROR. Vertical line wrong.\n");
-					drawCrossing(&md,xx0,y3,COLORRED);
-					md.saveAsBmp("_ERROR_vertical.bmp");
+					if (arep) {
+						arep->add(QCF_LINE,ext,nr,xx0,y3,xx0,y3);
+						erg=0;
+						break;
+					}
+					if (areport > 0) {
+						LOGMSG("ERROR. Vertical line wrong.\n");
+						drawCrossing(&md,xx0,y3,COLORRED);
+						md.saveAsBmp("_ERROR_vertical.bmp");
+					}
 					return 0;
 				}
 			}
@@ -1191,23 +2615,33 @@ int qcB2(
 			int x0,x1;
 			getMinMax(xx0,xx1,x0,x1);
 			
+			CharmapCursor c;
+			c.setTo(md,x0,yy0);
 			for(int x3=(x0+1);x3<=(x1-1);x3++) {
+				c.right();
 				// all points must be apolcol and upper and lower neighbour relf
 				if (
-					(md.getPoint(x3,yy0-1) == relf) &&
-					(md.getPoint(x3,yy0) == apolcol) &&
-					(md.getPoint(x3,yy0+1) == relf)
+					(c.at(0,-1) == relf) &&
+					(c.get() == apolcol) &&
+					(c.at(0,1) == relf)
 				) continue;
 				else {
-					LOGMSG("ERROR. Veritcal line wrong.\n");
-					drawCrossing(&md,x3,yy0,COLORRED);
-					md.saveAsBmp("_ERROR_vertical.bmp");
+					if (arep) {
+						arep->add(QCF_LINE,ext,nr,x3,yy0,x3,yy0);
+						erg=0;
+						break;
+					}
+					if (areport > 0) {
+						LOGMSG("ERROR. Veritcal line wrong.\n");
+						drawCrossing(&md,x3,yy0,COLORRED);
+						md.saveAsBmp("_ERROR_vertical.bmp");
+					}
 					return 0;
 				}
 			}
 		}
 	} // i
-	return 1;
+	return erg;
 }
 
 // polygons shall not cross each other
@@ -1218,10 +2652,35 @@ int qcB(
 	const BYTE relf,
 	const BYTE apolcol
 ) {
-	
+
 	// draw polygon's vertices and edges. They
 	// are only allowed to hit pixels with color af /and LILA which the drawn points are set to temporarily)
 	printf(".");
+	if (qcBRegion(md,apg,relf,NULL,0) <= 0) return 0;
+
+	printf(".");
+	// now 2nd pass: draw the polygon in apolcol
+	qcBDraw(md,apg,apolcol);
+
+	return 1;
+}
+
+int qcBRegion(
+	Charmap& md,
+	Polygon& apg,
+	const BYTE relf,
+	QcOverlay* aov,
+	const int aindex,
+	QcReport* arep
+) {
+	// first pass of qcB. aov: pixels drawn by polygons
+	// before aindex count as occupied, md is not changed
+	// and nothing reported
+	// arep (with aov): the first failing pixel of every edge
+	// goes to the report
+	int erg=1;
+	int ext=( (aindex >= intpcount) ? 1 : 0 );
+	int nr=( (ext > 0) ? aindex-intpcount : aindex );
 	int lx=-1,ly=-1;
 	int encx0=md.xlen-1,encx1=0;
 	int ency0=md.ylen-1,ency1=0;
@@ -1245,11 +2704,24 @@ int qcB(
 				// vertical line
 				int y0,y1;
 				getMinMax(ly,yy,y0,y1);
-				for(int y3=y0;y3<=y1;y3++) {
-					
-					for(int dy=-1;dy<=1;dy++) {
+				int kante=1;
+				CharmapCursor c;
+				c.setTo(md,xx,y0);
+				for(int y3=y0;((kante>0)&&(y3<=y1));y3++) {
+					if (y3 > y0) c.down();
+
+					for(int dy=-1;((kante>0)&&(dy<=1));dy++) {
 						for(int dx=-1;dx<=1; dx++) {
-							if (md.getPoint(xx+dx,y3+dy) != relf) {
+							if (
+								(c.at(dx,dy) != relf) ||
+								( (aov) && (aov->drawnBefore(xx+dx,y3+dy,aindex) > 0) )
+							) {
+								if (arep) {
+									arep->add(QCF_REGION,ext,nr,xx,y3,xx,y3);
+									erg=kante=0;
+									break;
+								}
+								if (aov) return 0;
 								LOGMSG("ERROR. Polygon lies in wrong region.\n");
 								drawCrossing(&md,xx,y3,COLORRED);
 								md.saveAsBmp("_ERROR_wrong_region.bmp");
@@ -1262,11 +2734,24 @@ int qcB(
 				// horizontal line
 				int x0,x1;
 				getMinMax(lx,xx,x0,x1);
-				for(int x3=x0;x3<=x1;x3++) {
-					
-					for(int dy=-1;dy<=1;dy++) {
+				int kante=1;
+				CharmapCursor c;
+				c.setTo(md,x0,yy);
+				for(int x3=x0;((kante>0)&&(x3<=x1));x3++) {
+					if (x3 > x0) c.right();
+
+					for(int dy=-1;((kante>0)&&(dy<=1));dy++) {
 						for(int dx=-1;dx<=1; dx++) {
-							if (md.getPoint(x3+dx,yy+dy) != relf) {
+							if (
+								(c.at(dx,dy) != relf) ||
+								( (aov) && (aov->drawnBefore(x3+dx,yy+dy,aindex) > 0) )
+							) {
+								if (arep) {
+									arep->add(QCF_REGION,ext,nr,x3,yy,x3,yy);
+									erg=kante=0;
+									break;
+								}
+								if (aov) return 0;
 								LOGMSG("ERROR. Polygon lies in wrong region.\n");
 								drawCrossing(&md,x3,yy,COLORRED);
 								md.saveAsBmp("_ERROR_wrong_region.bmp");
@@ -1275,7 +2760,11 @@ int qcB(
 						}
 					}
 				}
+			} else if (arep) {
+				arep->add(QCF_DIAGONAL,ext,nr,minimumI(lx,xx),minimumI(ly,yy),maximumI(lx,xx),maximumI(ly,yy));
+				erg=0;
 			} else {
+				if (aov) return 0;
 				LOGMSG("ERROR. Diagonal.\n");
 				drawCrossing(&md,lx,ly,COLORRED);
 				drawCrossing(&md,xx,yy,COLORRED);
@@ -1284,26 +2773,572 @@ int qcB(
 			}
 		} 
 		
-		lx=xx; 
+		lx=xx;
 		ly=yy;
 	}
-	
-	printf(".");
-	// now 2nd pass: draw the polygon in apolcol
+
+	return erg;
+}
+
+void qcBDraw(Charmap& md,Polygon& apg,const BYTE apolcol) {
+	// the polygon is closed, so starting without a previous
+	// point draws the same pixels as continuing from the last one
+	int lx=-1,ly=-1;
 	for(int i=0;i<apg.pointcount;i++) {
 		double d=apg.points[i].x; d /= apg.nenner;
 		int xx=inbildcoord(d);
 		d=apg.points[i].y; d /= apg.nenner;
 		int yy=inbildcoord(d);
 		if (lx>=0) md.lineVH(lx,ly,xx,yy,apolcol);
-		
+
 		lx=xx;
 		ly=yy;
 	}
-	
+}
+
+// struct QcOverlay
+
+inline void atomicMinI(std::atomic<int>& a,const int w) {
+	int alt=a.load();
+	while ( (w < alt) && (!a.compare_exchange_weak(alt,w)) ) ;
+}
+
+QcOverlay::QcOverlay(const int ax,const int ay) {
+	xlen=ax;
+	ylen=ay;
+	VLONG anz=(VLONG)xlen*ylen;
+	owner=new std::atomic<unsigned short>[anz];
+	for(VLONG i=0;i<anz;i++) owner[i].store(QCNOOWNER,std::memory_order_relaxed);
+}
+
+QcOverlay::~QcOverlay() {
+	delete[] owner;
+}
+
+void QcOverlay::drawPolygon(Polygon& apg,const int aindex) {
+	// the pixels qcBDraw sets with Charmap::lineVH
+	int lx=-1,ly=-1;
+	unsigned short idx=(unsigned short)aindex;
+	for(int i=0;i<apg.pointcount;i++) {
+		double d=apg.points[i].x; d /= apg.nenner;
+		int xx=inbildcoord(d);
+		d=apg.points[i].y; d /= apg.nenner;
+		int yy=inbildcoord(d);
+		if (lx>=0) {
+			int ax=lx,ay=ly,bx=xx,by=yy;
+			if (ax<0) ax=0; else if (ax >= xlen) ax=xlen-1;
+			if (ay<0) ay=0; else if (ay >= ylen) ay=ylen-1;
+			if (bx<0) bx=0; else if (bx >= xlen) bx=xlen-1;
+			if (by<0) by=0; else if (by >= ylen) by=ylen-1;
+			int x0=minimumI(ax,bx),x1=maximumI(ax,bx);
+			int y0=minimumI(ay,by),y1=maximumI(ay,by);
+			if ( (ax == bx) || (ay == by) ) {
+				for(int y=y0;y<=y1;y++) {
+					for(int x=x0;x<=x1;x++) {
+						std::atomic<unsigned short>& o=owner[(VLONG)y*xlen+x];
+						unsigned short alt=o.load(std::memory_order_relaxed);
+						while ( (idx < alt) && (!o.compare_exchange_weak(alt,idx)) ) ;
+					}
+				}
+			}
+		}
+		lx=xx;
+		ly=yy;
+	}
+}
+
+int QcOverlay::drawnBefore(const int ax,const int ay,const int aindex) {
+	if ( (ax < 0) || (ax >= xlen) || (ay < 0) || (ay >= ylen) ) return 0;
+	return ( owner[(VLONG)ay*xlen+ax].load(std::memory_order_relaxed) < aindex );
+}
+
+
+// struct IntervalTreap
+
+IntervalTreap::IntervalTreap() {
+	wurzel=-1;
+	zufall=0x5452454150ULL;
+}
+
+void IntervalTreap::update(const int k) {
+	Knoten& n=knoten[k];
+	n.maxhi=n.hi;
+	if ( (n.links >= 0) && (knoten[n.links].maxhi > n.maxhi) ) n.maxhi=knoten[n.links].maxhi;
+	if ( (n.rechts >= 0) && (knoten[n.rechts].maxhi > n.maxhi) ) n.maxhi=knoten[n.rechts].maxhi;
+}
+
+void IntervalTreap::split(const int t,const int alo,const int aseg,int& a,int& b) {
+	// a: keys < (alo,aseg), b: the others
+	if (t < 0) {
+		a=b=-1;
+		return;
+	}
+	if ( (knoten[t].lo < alo) || ( (knoten[t].lo == alo) && (knoten[t].seg < aseg) ) ) {
+		split(knoten[t].rechts,alo,aseg,knoten[t].rechts,b);
+		a=t;
+	} else {
+		split(knoten[t].links,alo,aseg,a,knoten[t].links);
+		b=t;
+	}
+	update(t);
+}
+
+int IntervalTreap::merge(const int a,const int b) {
+	if (a < 0) return b;
+	if (b < 0) return a;
+	if (knoten[a].prio > knoten[b].prio) {
+		knoten[a].rechts=merge(knoten[a].rechts,b);
+		update(a);
+		return a;
+	}
+	knoten[b].links=merge(a,knoten[b].links);
+	update(b);
+	return b;
+}
+
+void IntervalTreap::insert(const int alo,const int ahi,const int aseg) {
+	int k;
+	if (frei.size() > 0) {
+		k=frei.back();
+		frei.pop_back();
+	} else {
+		k=(int)knoten.size();
+		knoten.push_back(Knoten());
+	}
+	Knoten& n=knoten[k];
+	n.lo=alo;
+	n.hi=n.maxhi=ahi;
+	zufall=zufall*6364136223846793005ULL+1442695040888963407ULL;
+	n.prio=(unsigned int)(zufall >> 32);
+	n.links=n.rechts=-1;
+	n.seg=aseg;
+	int a,b;
+	split(wurzel,alo,aseg,a,b);
+	wurzel=merge(merge(a,k),b);
+}
+
+void IntervalTreap::erase(const int alo,const int aseg) {
+	int a,b,m,c;
+	split(wurzel,alo,aseg,a,b);
+	split(b,alo,aseg+1,m,c);
+	if (m >= 0) frei.push_back(m);
+	wurzel=merge(a,c);
+}
+
+void IntervalTreap::queryFrom(const int t,const int alo,const int ahi,std::vector<int>& aerg) {
+	if ( (t < 0) || (knoten[t].maxhi < alo) ) return;
+	queryFrom(knoten[t].links,alo,ahi,aerg);
+	if (knoten[t].lo > ahi) return;
+	if (knoten[t].hi >= alo) aerg.push_back(knoten[t].seg);
+	queryFrom(knoten[t].rechts,alo,ahi,aerg);
+}
+
+void IntervalTreap::query(const int alo,const int ahi,std::vector<int>& aerg) {
+	// all stored intervals meeting [alo,ahi]
+	aerg.clear();
+	queryFrom(wurzel,alo,ahi,aerg);
+}
+
+
+// struct QcReport
+
+QcReport::QcReport() {
+	anzahl=0;
+}
+
+void QcReport::add(const int acheck,const int aext,const int apolygon,const int ax0,const int ay0,const int ax1,const int ay1) {
+	// thread-safe
+	std::lock_guard<std::mutex> lock(mutex);
+	if (gesehen.insert(std::make_tuple(acheck,aext,apolygon,ax0,ay0,ax1,ay1)).second == false) return;
+	anzahl++;
+	if ((int)eintraege.size() >= QCREPORTMAX) return;
+	Eintrag e;
+	e.check=acheck;
+	e.ext=aext;
+	e.polygon=apolygon;
+	e.x0=ax0;
+	e.y0=ay0;
+	e.x1=ax1;
+	e.y1=ay1;
+	eintraege.push_back(e);
+}
+
+int QcReport::save(const char* afn) {
+	// sorted, so the file does not depend on the thread schedule
+	std::sort(eintraege.begin(),eintraege.end(),[](const Eintrag& a,const Eintrag& b) {
+		if (a.check != b.check) return (a.check < b.check);
+		if (a.ext != b.ext) return (a.ext < b.ext);
+		if (a.polygon != b.polygon) return (a.polygon < b.polygon);
+		if (a.y0 != b.y0) return (a.y0 < b.y0);
+		return (a.x0 < b.x0);
+	});
+	FILE *f=fopen(afn,"wt");
+	if (!f) return 0;
+	const char* namen[]={"structure","region","diagonal","vertex","line","oracle"};
+	fprintf(f,"check,kind,polygon,x0,y0,x1,y1\n");
+	for(int i=0;i<(int)eintraege.size();i++) {
+		Eintrag& e=eintraege[i];
+		fprintf(f,"%s,%s,%i,%i,%i,%i,%i\n",namen[e.check],(e.ext > 0) ? "exterior" : "interior",
+			e.polygon,e.x0,e.y0,e.x1,e.y1);
+	}
+	if (anzahl > (VLONG)eintraege.size()) {
+		fprintf(f,"# %lld more not listed\n",(long long)(anzahl-(VLONG)eintraege.size()));
+	}
+	fclose(f);
+	return 1;
+}
+
+void QcReport::annotate(Charmap& md) {
+	// a red box around every location. Structure findings
+	// have none
+	for(int i=0;i<(int)eintraege.size();i++) {
+		Eintrag& e=eintraege[i];
+		if (e.check == QCF_STRUCTURE) continue;
+		md.lineVH(e.x0-10,e.y0-10,e.x1+10,e.y0-10,COLORRED);
+		md.lineVH(e.x0-10,e.y1+10,e.x1+10,e.y1+10,COLORRED);
+		md.lineVH(e.x0-10,e.y0-10,e.x0-10,e.y1+10,COLORRED);
+		md.lineVH(e.x1+10,e.y0-10,e.x1+10,e.y1+10,COLORRED);
+	}
+}
+
+
+// struct QcCheckpoint
+
+QcCheckpoint::QcCheckpoint() {
+	hash=0;
+	phase=QCPHASE_STRUCTURE;
+	letzte=std::chrono::steady_clock::now();
+}
+
+int QcCheckpoint::load(const char* afn) {
+	// text file:
+	//  QCCHECKPOINT 1
+	//  hash <16 hex digits>
+	//  phase <0..3>
+	//  rows <image rows>
+	//  done <y0>-<y1>  (finished oracle rows, any number of lines)
+	FILE *f=fopen(afn,"rt");
+	if (!f) return 0;
+	char tmp[1024];
+	int version=0,rows=-1;
+	unsigned long long h=0;
+	int ok=1;
+	if ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"QCCHECKPOINT %i",&version) != 1) || (version != 1) ) ok=0;
+	if ( (ok>0) && ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"hash %llx",&h) != 1) ) ) ok=0;
+	if ( (ok>0) && ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"phase %i",&phase) != 1) ) ) ok=0;
+	if ( (ok>0) && ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"rows %i",&rows) != 1) || (rows < 0) ) ) ok=0;
+	if (ok > 0) {
+		hash=h;
+		erledigt.assign(rows,0);
+		while (fgets(tmp,1000,f) != NULL) {
+			int y0,y1;
+			if (sscanf(tmp,"done %i-%i",&y0,&y1) != 2) continue;
+			for(int y=maximumI(0,y0);y<=minimumI(rows-1,y1);y++) erledigt[y]=1;
+		}
+	}
+	fclose(f);
+	if ( (phase < QCPHASE_STRUCTURE) || (phase > QCPHASE_SMALL) ) ok=0;
+
+	return ok;
+}
+
+int QcCheckpoint::save(const char* afn) {
+	// written to a temporary file first, so an interruption
+	// while saving leaves the previous checkpoint intact
+	char fn[1024];
+	sprintf(fn,"%s.tmp",afn);
+	FILE *f=fopen(fn,"wt");
+	if (!f) return 0;
+	fprintf(f,"QCCHECKPOINT 1\nhash %016llx\nphase %i\nrows %i\n",hash,phase,(int)erledigt.size());
+	int n=(int)erledigt.size();
+	for(int y=0;y<n;) {
+		if (erledigt[y] <= 0) {
+			y++;
+			continue;
+		}
+		int y1=y;
+		while ( (y1+1 < n) && (erledigt[y1+1] > 0) ) y1++;
+		fprintf(f,"done %i-%i\n",y,y1);
+		y=y1+1;
+	}
+	fclose(f);
+	remove(afn);
+	if (rename(fn,afn) != 0) return 0;
+	letzte=std::chrono::steady_clock::now();
+
+	return 1;
+}
+
+int QcCheckpoint::due(void) {
+	// short runs never write a checkpoint
+	if (qccheckpointsek <= 0) return 0;
+	double sek=std::chrono::duration<double>(std::chrono::steady_clock::now()-letzte).count();
+	return (sek >= qccheckpointsek);
+}
+
+void QcCheckpoint::advance(const int aphase) {
+	// never back: a resumed run passes the earlier marks too
+	std::lock_guard<std::mutex> lock(mutex);
+	if (aphase > phase) phase=aphase;
+	if (phase > QCPHASE_ORACLE) erledigt.assign(erledigt.size(),1);
+	if (due() > 0) save(QCCHECKPOINTFN);
+}
+
+void QcCheckpoint::rowDone(const int ay) {
+	std::lock_guard<std::mutex> lock(mutex);
+	erledigt[ay]=1;
+	if (due() > 0) save(QCCHECKPOINTFN);
+}
+
+int QcCheckpoint::isDone(const int ay) {
+	std::lock_guard<std::mutex> lock(mutex);
+	return erledigt[ay];
+}
+
+
+// struct QcCache
+
+int QcCache::load(const char* afn) {
+	// text file: "QCCACHE 1", then one line per key:
+	// <kind 0..3> <16 hex digits>
+	for(int k=0;k<4;k++) keys[k].clear();
+	FILE *f=fopen(afn,"rt");
+	if (!f) return 0;
+	char tmp[1024];
+	int version=0;
+	if ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"QCCACHE %i",&version) != 1) || (version != 1) ) {
+		fclose(f);
+		return 0;
+	}
+	while (fgets(tmp,1000,f) != NULL) {
+		int k;
+		unsigned long long h;
+		if (sscanf(tmp,"%i %llx",&k,&h) != 2) continue;
+		if ( (k < 0) || (k > 3) ) continue;
+		keys[k].push_back(h);
+	}
+	fclose(f);
+	for(int k=0;k<4;k++) std::sort(keys[k].begin(),keys[k].end());
+
+	return 1;
+}
+
+int QcCache::save(const char* afn) {
+	char fn[1024];
+	sprintf(fn,"%s.tmp",afn);
+	FILE *f=fopen(fn,"wt");
+	if (!f) return 0;
+	fprintf(f,"QCCACHE 1\n");
+	for(int k=0;k<4;k++) {
+		std::sort(keys[k].begin(),keys[k].end());
+		keys[k].erase(std::unique(keys[k].begin(),keys[k].end()),keys[k].end());
+		for(int i=0;i<(int)keys[k].size();i++) fprintf(f,"%i %016llx\n",k,keys[k][i]);
+	}
+	fclose(f);
+	remove(afn);
+	if (rename(fn,afn) != 0) return 0;
+
+	return 1;
+}
+
+void QcCache::add(const int akind,const unsigned long long akey) {
+	keys[akind].push_back(akey);
+}
+
+int QcCache::has(const int akind,const unsigned long long akey) {
+	// keys loaded are sorted, added ones are not looked up
+	return std::binary_search(keys[akind].begin(),keys[akind].end(),akey) ? 1 : 0;
+}
+
+
+// struct QcShardResult
+
+QcShardResult::QcShardResult() {
+	hash=0;
+	shard=0;
+	shards=1;
+	structure=region=touch=-2;
+	oracleart=-2;
+	oraclex=oracley=0;
+}
+
+int QcShardResult::load(const char* afn) {
+	// text file:
+	//  QCSHARD 1
+	//  hash <16 hex digits>
+	//  shard <i> <n>
+	//  structure <polygon>
+	//  region <polygon>
+	//  touch <polygon>
+	//  oracle <kind> <x> <y>
+	FILE *f=fopen(afn,"rt");
+	if (!f) return 0;
+	char tmp[1024];
+	int version=0;
+	int ok=1;
+	if ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"QCSHARD %i",&version) != 1) || (version != 1) ) ok=0;
+	if ( (ok>0) && ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"hash %llx",&hash) != 1) ) ) ok=0;
+	if ( (ok>0) && ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"shard %i %i",&shard,&shards) != 2) ) ) ok=0;
+	if ( (ok>0) && ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"structure %i",&structure) != 1) ) ) ok=0;
+	if ( (ok>0) && ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"region %i",&region) != 1) ) ) ok=0;
+	if ( (ok>0) && ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"touch %i",&touch) != 1) ) ) ok=0;
+	if ( (ok>0) && ( (fgets(tmp,1000,f) == NULL) || (sscanf(tmp,"oracle %i %i %i",&oracleart,&oraclex,&oracley) != 3) ) ) ok=0;
+	fclose(f);
+	if ( (shards < 1) || (shard < 0) || (shard >= shards) ) ok=0;
+
+	return ok;
+}
+
+int QcShardResult::save(const char* afn) {
+	// via a temporary file: a merge never sees half a result
+	char fn[1024];
+	sprintf(fn,"%s.tmp",afn);
+	FILE *f=fopen(fn,"wt");
+	if (!f) return 0;
+	fprintf(f,"QCSHARD 1\nhash %016llx\nshard %i %i\n",hash,shard,shards);
+	fprintf(f,"structure %i\nregion %i\ntouch %i\n",structure,region,touch);
+	fprintf(f,"oracle %i %i %i\n",oracleart,oraclex,oracley);
+	fclose(f);
+	remove(afn);
+	if (rename(fn,afn) != 0) return 0;
+
 	return 1;
 }
 
+void QcShardResult::merge(QcShardResult& b) {
+	// a failure wins over passed and not run, the lowest
+	// failure over the others; not run over passed
+	int* wa[3]={&structure,&region,&touch};
+	int wb[3]={b.structure,b.region,b.touch};
+	for(int i=0;i<3;i++) {
+		int& a=*wa[i];
+		if (wb[i] >= 0) {
+			if ( (a < 0) || (wb[i] < a) ) a=wb[i];
+		} else if ( (a == -1) && (wb[i] == -2) ) a=-2;
+	}
+	if (b.oracleart >= 0) {
+		if ( (oracleart < 0) || (b.oracley < oracley) || ( (b.oracley == oracley) && (b.oraclex < oraclex) ) ) {
+			oracleart=b.oracleart;
+			oraclex=b.oraclex;
+			oracley=b.oracley;
+		}
+	} else if ( (oracleart == -1) && (b.oracleart == -2) ) oracleart=-2;
+}
+
+int QcShardResult::complete(void) {
+	// every check up to the first failure was run by all
+	// shards
+	int w[3]={structure,region,touch};
+	for(int i=0;i<3;i++) {
+		if (w[i] >= 0) return 1;
+		if (w[i] < -1) return 0;
+	}
+	return (oracleart >= -1) ? 1 : 0;
+}
+
+
+// geometric spacing check
+
+int qcGeometric(void) {
+	// the raster check (qcB) lets no pixel of a polygon come
+	// within one pixel (8-neighbourhood) of a pixel of an
+	// earlier one. The same on the edges themselves: their pixel
+	// boxes, grown by one pixel, must not meet for different
+	// polygons. Sweep over x, active y-intervals in a treap.
+	// Within one polygon only proper crossings are reported,
+	// the finer rules stay with qcB2
+	std::vector<GeoSegment> segs;
+	int anzp=intpcount+extpcount;
+	for(int p=0;p<anzp;p++) {
+		Polygon& pg=( (p<intpcount) ? intp[p] : extp[p-intpcount] );
+		for(int i=1;i<pg.pointcount;i++) {
+			GeoSegment s;
+			int xa=inbildcoord( (double)pg.points[i-1].x / pg.nenner);
+			int ya=inbildcoord( (double)pg.points[i-1].y / pg.nenner);
+			int xb=inbildcoord( (double)pg.points[i].x / pg.nenner);
+			int yb=inbildcoord( (double)pg.points[i].y / pg.nenner);
+			getMinMax(xa,xb,s.x0,s.x1);
+			getMinMax(ya,yb,s.y0,s.y1);
+			s.polygon=p;
+			s.index=i;
+			segs.push_back(s);
+		}
+	}
+
+	// events: (x, 0=remove / 1=insert, segment). A box covers
+	// x0..x1+1 after growing, so it leaves at x1+2
+	std::vector<std::pair<std::pair<int,int>,int> > events;
+	events.reserve(2*segs.size());
+	for(int k=0;k<(int)segs.size();k++) {
+		events.push_back(std::make_pair(std::make_pair(segs[k].x0,1),k));
+		events.push_back(std::make_pair(std::make_pair(segs[k].x1+2,0),k));
+	}
+	std::sort(events.begin(),events.end());
+
+	IntervalTreap aktiv;
+	std::vector<int> treffer;
+	int fa=-1,fb=-1;
+	for(int e=0;((fa<0)&&(e<(int)events.size()));e++) {
+		int b=events[e].second;
+		GeoSegment& sb=segs[b];
+		if (events[e].first.second == 0) {
+			aktiv.erase(sb.y0,b);
+			continue;
+		}
+		aktiv.query(sb.y0,sb.y1+1,treffer);
+		for(int t=0;t<(int)treffer.size();t++) {
+			GeoSegment& sa=segs[treffer[t]];
+			if (sa.polygon != sb.polygon) {
+				fa=treffer[t];
+				fb=b;
+				break;
+			}
+			// same polygon: a vertical and a horizontal edge
+			// crossing in a pixel inside both
+			GeoSegment* v=( (sa.x0 == sa.x1) ? &sa : &sb );
+			GeoSegment* h=( (sa.x0 == sa.x1) ? &sb : &sa );
+			if (
+				(v->x0 == v->x1) && (h->y0 == h->y1) && (v != h) &&
+				(h->x0 < v->x0) && (v->x0 < h->x1) &&
+				(v->y0 < h->y0) && (h->y0 < v->y1)
+			) {
+				fa=treffer[t];
+				fb=b;
+				break;
+			}
+		}
+		if (fa < 0) aktiv.insert(sb.y0,sb.y1+1,b);
+	}
+
+	if (fa < 0) return 1;
+
+	// report at the pixel of the later edge nearest to the other
+	GeoSegment& sa=segs[fa];
+	GeoSegment& sb=segs[fb];
+	int px=maximumI(sb.x0,minimumI(sb.x1,sa.x0));
+	int py=maximumI(sb.y0,minimumI(sb.y1,sa.y0));
+	char tmp[1024];
+	int pa=sa.polygon,pb=sb.polygon;
+	if (pa == pb) {
+		sprintf(tmp,"\nERROR. Geometric check: %s polygon %i crosses itself (edges %i and %i) at image coordinates %i,%i\n",
+			(pa<intpcount) ? "interior" : "exterior",(pa<intpcount) ? pa : pa-intpcount,sa.index,sb.index,px,py);
+	} else {
+		sprintf(tmp,"\nERROR. Geometric check: %s polygon %i and %s polygon %i closer than one pixel at image coordinates %i,%i\n",
+			(pa<intpcount) ? "interior" : "exterior",(pa<intpcount) ? pa : pa-intpcount,
+			(pb<intpcount) ? "interior" : "exterior",(pb<intpcount) ? pb : pb-intpcount,px,py);
+	}
+	LOGMSG2("%s",tmp);
+	for(int k=0;k<2;k++) {
+		int p=( (k == 0) ? pa : pb );
+		if (p < intpcount) qcBDraw(inbild,intp[p],INTPOLCOL);
+		else qcBDraw(inbild,extp[p-intpcount],EXTPOLCOL);
+	}
+	drawCrossing(&inbild,px,py,COLORRED);
+	inbild.saveAsBmp("_ERROR_geometric.bmp");
+
+	return 0;
+}
+
 void drawOnePolygon(Charmap& md,Polygon& pol,const BYTE af) {
 	double SKX=md.xlen; SKX /= (RANGE1-RANGE0);
 	double SKY=md.ylen; SKY /= (RANGE1-RANGE0);
@@ -1327,7 +3362,8 @@ void unPrepareYOracle(void) {
 	for(int i=0;i<extpcount;i++) extp[i].unPrepareY();
 }
 
-void prepareYOracle(const double ay) {
+void prepareYOracle(const double ay0) {
+	double ay=foldSymmetryY(symmetry,ay0);
 	for(int i=0;i<intpcount;i++) {
 		int py=(int)floor(ay*intp[i].nenner);
 		intp[i].prepareY(py);
@@ -1345,71 +3381,180 @@ void prepareYOracle(const double ay) {
 //
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
-int jsoracle(const double ax,const double ay) {
+int jsoracle(const double ax,const double ay,RowPrepare* arp) {
+	double x=ax,y=ay;
+	foldSymmetry(symmetry,x,y);
+	return jsoracleWith(intp,intpcount,extp,extpcount,x,y,arp);
+}
+
+int jsoracleExteriorOnly(const double ax,const double ay,RowPrepare* arp) {
+	// verdict of the exterior polygons alone: EXTERIOR or
+	// UNKNOWN. Reentrant, the global set is not changed
+	double x=ax,y=ay;
+	foldSymmetry(symmetry,x,y);
+	return jsoracleWith(NULL,0,extp,extpcount,x,y,arp);
+}
+
+int jsoracleInteriorOnly(const double ax,const double ay,RowPrepare* arp) {
+	// verdict of the interior polygons alone: INTERIOR or UNKNOWN
+	double x=ax,y=ay;
+	foldSymmetry(symmetry,x,y);
+	return jsoracleWith(intp,intpcount,NULL,0,x,y,arp);
+}
+
+int jsoracleWith(
+	Polygon* aintp,const int aintpcount,
+	Polygon* aextp,const int aextpcount,
+	const double ax,const double ay,
+	RowPrepare* arp
+) {
+	// oracle on an explicitly given set of polygons
+	// arp: if given, thread-private row preparation
+	// for row ay instead of the polygon's own
 	int mxy=2;
 	// how many pixels in total with two layers
 	// of neighbours
 	int AREA=((mxy+mxy+1)*(mxy+mxy+1));
 	
-	for(int i=0;i<intpcount;i++) {
-		int px=(int)floor(ax*intp[i].nenner);
-		int py=(int)floor(ay*intp[i].nenner);
+	for(int i=0;i<aintpcount;i++) {
+		int px=(int)floor(ax*aintp[i].nenner);
+		int py=(int)floor(ay*aintp[i].nenner);
+		if (aintp[i].lazy > 0) {
+			// vertices are only needed if the whole stencil
+			// lies in the bounding box, otherwise one grid point
+			// already is exterior
+			if (
+				((px-mxy) < aintp[i].xmin) || ((px+mxy) > aintp[i].xmax) ||
+				((py-mxy) < aintp[i].ymin) || ((py+mxy) > aintp[i].ymax)
+			) {
+				COUNT(bboxrejects)
+				continue;
+			}
+			aintp[i].ensureLoaded();
+		}
+		COUNT(polygons)
 		int ic=0;
 		for(int dy=-mxy;((ic>=0)&&(dy<=mxy));dy++) {
 			for(int dx=-mxy;((ic>=0)&&(dx<=mxy));dx++) {
-				if (point_in_polygonVH(intp[i],px+dx,py+dy) == PIP_INTERIOR) ic++;
-				else ic=-1;
+				if (point_in_polygonVH(aintp[i],px+dx,py+dy,arp ? arp->intprep[i] : NULL) == PIP_INTERIOR) ic++;
+				else {
+					ic=-1;
+					COUNTIF( (dy<mxy) || (dx<mxy),earlyexits )
+				}
 			}
 		}
 		
 		// if in ONE interior polygon => return INTERIOR
-		if (ic == AREA) return PIP_INTERIOR;
+		if (ic == AREA) {
+			COUNT(verdict[PIP_INTERIOR])
+			return PIP_INTERIOR;
+		}
 	} 
 	
 	int ergext=PIP_UNKNOWN;
-	for(int i=0;i<extpcount;i++) if (extp[i].pointcount>0) {
+	for(int i=0;i<aextpcount;i++) if (aextp[i].pointcount>0) {
 		int ic=0;
-		int px=(int)floor(ax*extp[i].nenner);
-		int py=(int)floor(ay*extp[i].nenner);
+		int px=(int)floor(ax*aextp[i].nenner);
+		int py=(int)floor(ay*aextp[i].nenner);
+		if (aextp[i].lazy > 0) {
+			// stencil completely outside the bounding box:
+			// all grid points are exterior without looking
+			// at the vertices
+			if (
+				((px+mxy) < aextp[i].xmin) || ((px-mxy) > aextp[i].xmax) ||
+				((py+mxy) < aextp[i].ymin) || ((py-mxy) > aextp[i].ymax)
+			) {
+				COUNT(bboxrejects)
+				ergext=PIP_EXTERIOR;
+				continue;
+			}
+			aextp[i].ensureLoaded();
+		}
+		COUNT(polygons)
 		for(int dy=-mxy;((ic>=0)&&(dy<=mxy));dy++) {
 			for(int dx=-mxy;((ic>=0)&&(dx<=mxy));dx++) {
-				if (point_in_polygonVH(extp[i],px+dx,py+dy) == PIP_EXTERIOR) ic++;
-				else ic=-1;
+				if (point_in_polygonVH(aextp[i],px+dx,py+dy,arp ? arp->extprep[i] : NULL) == PIP_EXTERIOR) ic++;
+				else {
+					ic=-1;
+					COUNTIF( (dy<mxy) || (dx<mxy),earlyexits )
+				}
 			}
 		}
 		
-		if (ic != AREA) return PIP_UNKNOWN; else ergext=PIP_EXTERIOR;
+		if (ic != AREA) {
+			COUNT(verdict[PIP_UNKNOWN])
+			return PIP_UNKNOWN; 
+		} else ergext=PIP_EXTERIOR;
 	} 
 
 	// if outside ALL etxerior polygons => exterior
 	if (
 		(ergext == PIP_EXTERIOR) && 
-		(extpcount>0)
-	) return PIP_EXTERIOR;
+		(aextpcount>0)
+	) {
+		COUNT(verdict[PIP_EXTERIOR])
+		return PIP_EXTERIOR;
+	}
 
+	COUNT(verdict[PIP_UNKNOWN])
+	return PIP_UNKNOWN;
+}
+
+int jsoracleCascade(const double ax,const double ay,int& alevel) {
+	// polygon sets ordered coarse to fine. Every set is
+	// quality controlled on its own, so a definite answer
+	// of a coarse set is final and only UNKNOWN falls
+	// through to the next finer set
+	for(int l=0;l<cascadecount;l++) {
+		alevel=l;
+		double x=ax,y=ay;
+		foldSymmetry(cascade[l].symmetry,x,y);
+		int erg=jsoracleWith(
+			cascade[l].intp,cascade[l].intpcount,
+			cascade[l].extp,cascade[l].extpcount,
+			x,y
+		);
+		if (erg != PIP_UNKNOWN) return erg;
+	}
+	
 	return PIP_UNKNOWN;
 }
 
 void oracleComplexNumber(const double apx,const double apy) {
 	// polygons must already be loaded
-	if ( (intpcount<=0) && (extpcount<=0) ) {
+	if ( (intpcount<=0) && (extpcount<=0) && (cascadecount<=0) ) {
 		LOGMSG("\n\nERROR. No polygons loaded.\n");
 		return;
 	}
 	LOGMSG3("point (%.20lg,%.20lg) ",apx,apy);
-	int jserg=jsoracle(apx,apy);
+	int level=-1;
+	int jserg;
+	if (cascadecount>0) jserg=jsoracleCascade(apx,apy,level);
+	else jserg=jsoracle(apx,apy);
 
 	switch (jserg) {
-		case PIP_INTERIOR: LOGMSG("definite INTERIOR\n"); break;
-		case PIP_EXTERIOR: LOGMSG("definite EXTERIOR\n"); break;
-		case PIP_UNKNOWN: LOGMSG("unknown\n"); break;
-		default: LOGMSG2("\n\nERROR. jsoracle result %i\n",jserg); break;
+		case PIP_INTERIOR: LOGMSG("definite INTERIOR"); break;
+		case PIP_EXTERIOR: LOGMSG("definite EXTERIOR"); break;
+		case PIP_UNKNOWN: LOGMSG("unknown"); break;
+		default: LOGMSG2("\n\nERROR. jsoracle result %i\n",jserg); return;
+	}
+	
+	if ( (cascadecount>0) && (jserg != PIP_UNKNOWN) ) {
+		LOGMSG2(" (cascade level %i)",level);
 	}
+	LOGMSG("\n");
 }
 
 void oracle(const char* afn,const double apx,const double apy) {
 	// load all polygons
-	loadAllPolygons();
+	if (cascadecount>0) {
+		cascade=new PolygonSet[cascadecount];
+		for(int l=0;l<cascadecount;l++) {
+			cascade[l].load(cascadepath[l],lazyload);
+			LOGMSG3("cascade level %i: polygon set '%s' ",l,cascadepath[l]);
+			LOGMSG3("with %i interior and %i exterior polygons\n",cascade[l].intpcount,cascade[l].extpcount);
+		}
+	} else loadAllPolygons(lazyload);
 
 	if ((!afn) || (afn[0]<32)) {
 		// one point
@@ -1424,13 +3569,22 @@ void oracle(const char* afn,const double apx,const double apy) {
 			double px,py;
 			if (sscanf(tmp,"%lf,%lf",&px,&py) == 2) {
 				oracleComplexNumber(px,py);
+			} else if (strcmp(upper(tmp),"#COUNTERS")==0) {
+				// on demand: counters so far
+				writeOracleCounters(stdout,1);
+				if (flog) writeOracleCounters(flog,1);
 			}
 		}
 		fclose(f);
 	}
 	
+	if (cascade) {
+		delete[] cascade;
+		cascade=NULL;
+	}
 	delete[] intp;
 	delete[] extp;
+	intp=extp=NULL;
 }
 
 // test whether a (rational) point is inside or outsiude
@@ -1447,8 +3601,16 @@ void oracle(const char* afn,const double apx,const double apy) {
 int point_in_polygonVH(
 	Polygon& apg,
 	const int ax,
-	const int ay
+	const int ay,
+	const int* aprepare
 ) {
+	// aprepare: externally prepared segment chain (see
+	// Polygon::prepareYTo), otherwise the polygon's own
+	// if activated
+	const int* prep=aprepare;
+	if ( (!prep) && (apg.useprepare>0) ) prep=apg.yprepare;
+	COUNT(pipcalls)
+	
 	// if outside the bounding rectangle of a polygon
 	// the result is exterior
 	
@@ -1457,7 +3619,10 @@ int point_in_polygonVH(
 		(ax > apg.xmax) ||
 		(ay < apg.ymin) ||
 		(ay > apg.ymax) 
-	) return PIP_EXTERIOR;
+	) {
+		COUNT(bboxrejects)
+		return PIP_EXTERIOR;
+	}
 
 	// if on the lines of the polygon (only horizontal
 	// and vertical lines present by construction)
@@ -1466,12 +3631,13 @@ int point_in_polygonVH(
 	int even=1;
 	int i=0; // not 1, since incrementing is at start of while loop
 	while (i<(apg.pointcount-1)) {
-		if (apg.useprepare>0) {
-			i=apg.yprepare[i];
+		if (prep) {
+			i=prep[i];
 		} else {
 			i++;
 		}
 		if (i >= apg.pointcount) break;
+		COUNT(edges)
 
 		if (apg.points[i].x == apg.points[i-1].x) {
 			// vertical line
@@ -1481,7 +3647,10 @@ int point_in_polygonVH(
 			if (
 				(apg.points[i].x == ax) &&
 				(miy <= ay) && (ay <= may)
-			) return PIP_BOUNDARY;
+			) {
+				COUNT(boundary)
+				return PIP_BOUNDARY;
+			}
 			
 			// does the horizontal ray intersect with this vertical segment
 			if (
@@ -1518,7 +3687,10 @@ int point_in_polygonVH(
 			if (
 				(apg.points[i].y == ay) &&
 				(minx <= ax) && (ax <= maxx)
-			) return PIP_BOUNDARY;
+			) {
+				COUNT(boundary)
+				return PIP_BOUNDARY;
+			}
 
 			// are ray and segment colinear ?
 			
@@ -1606,233 +3778,3024 @@ int qcA(Polygon& apg) {
 	return 1;
 }
 
-void loadAllPolygons(void) {
-	if (extp) delete[] extp;
-	if (intp) delete[] extp;
-	
-	extpcount=0;
-	intpcount=0;
-	extp=new Polygon[MAXPOLYGONE];
-	intp=new Polygon[MAXPOLYGONE];
+void loadAllPolygons(const int alazy) {
+	if (bundlefn[0]) {
+		// a bundle is already usable in place
+		if (mapBundle(bundlefn,intp,intpcount,extp,extpcount,&symmetry) <= 0) exit(99);
+	} else {
+		loadPolygons(polypath,intp,intpcount,extp,extpcount,alazy);
+		symmetry=loadSymmetry(polypath);
+	}
 	
-	int searche=1,searchi=1;
-	char tmp[1024];
+	if ( (symmetryarg >= 0) && (symmetryarg != symmetry) ) {
+		LOGMSG("\nERROR. SYMMETRY= differs from the symmetry the polygons were constructed with.\n");
+		exit(99);
+	}
+}
+
+// symmetric sets: the polygons of the upper half plane (imaginary
+// part >= 0) plus the ones crossing the real axis are stored, a
+// query in the lower half is mirrored before being answered.
+// The symmetry is recorded in the file prefix+"polysymmetry"
+// (or the bundle header), so the oracle cannot be run with a
+// different one
+
+int loadSymmetry(const char* aprefix) {
+	char tmp[2048];
+	sprintf(tmp,"%spolysymmetry",aprefix);
+	FILE *f=fopen(tmp,"rt");
+	if (!f) return SYM_NONE;
 	
-	while ( (searche>0) || (searchi>0) ) {
-		if (searchi>0) {
-			sprintf(tmp,"intpoly%04i",intpcount);
-			if (intp[intpcount].load(tmp) <= 0) searchi=0; else {
-				intpcount++;
-			}
+	int erg=SYM_NONE;
+	if (fgets(tmp,1000,f) != NULL) {
+		chomp(tmp);
+		upper(tmp);
+		if (strcmp(tmp,"POINT")==0) erg=SYM_POINT;
+		else if (strcmp(tmp,"CONJ")==0) erg=SYM_CONJ;
+		else {
+			LOGMSG2("\nERROR. Unknown symmetry in %spolysymmetry.\n",aprefix);
+			exit(99);
 		}
-		
-		if (searche>0) {
-			sprintf(tmp,"extpoly%04i",extpcount);
-			if (extp[extpcount].load(tmp) <= 0) searche=0; else {
-				extpcount++;
-			}
+	}
+	fclose(f);
+	
+	return erg;
+}
+
+int saveSymmetry(const char* aprefix,const int asym) {
+	char tmp[2048];
+	sprintf(tmp,"%spolysymmetry",aprefix);
+	FILE *f=fopen(tmp,"wt");
+	if (!f) {
+		LOGMSG2("\nERROR. Cannot write %s.\n",tmp);
+		return 0;
+	}
+	fprintf(f,"%s\n",(asym == SYM_POINT) ? "point" : "conj");
+	fclose(f);
+	
+	return 1;
+}
+
+int imageSymmetric(Charmap& abild,const int asym) {
+	// pixel x covers [x*skala+RANGE0,(x+1)*skala+RANGE0), with
+	// RANGE0=-RANGE1 its mirror image -x is pixel xlen-1-x
+	for(int y=0;y<abild.ylen;y++) {
+		int my=abild.ylen-1-y;
+		for(int x=0;x<abild.xlen;x++) {
+			int mx=( (asym == SYM_POINT) ? abild.xlen-1-x : x );
+			if (abild.getPoint(x,y) != abild.getPoint(mx,my)) return 0;
 		}
 	}
+	
+	return 1;
 }
 
-int qualitycontrol(void) {
-	int allvalid=1;
-	Charmap small;
-	int SMALLLEN=512;
-	small.setlenxy(SMALLLEN,SMALLLEN);
-	setPaletteTo(small);
-	small.fill(COLORGRAY);
+// binary polygon bundle: one file for a whole set that is
+// memory-mapped read-only and used in place, so several
+// oracle processes share one copy in the page cache
+//	BundleHeader
+//	BundleEntry for every interior, then every exterior polygon
+//	vertex arrays (int32 x,y pairs), each starting at a multiple
+//	of BUNDLEALIGN bytes
+// numbers are stored in the byte order of the writing machine
+
+int writeBundle(const char* afn) {
+	// writes the global polygon set
+	FILE *f=fopen(afn,"wb");
+	if (!f) {
+		LOGMSG2("\nERROR. Cannot write bundle %s.\n",afn);
+		return 0;
+	}
 	
-	// some non-power2 non-standard region
-	double mm=0.5*(RANGE0+RANGE1);
-	double br=0.783*(RANGE1-RANGE0);
-	double sm0=mm-br;
-	double sm1=mm+br;
-	double smallskala=(double)(sm1-sm0) / SMALLLEN;
+	BundleHeader hd;
+	memset(&hd,0,sizeof(hd));
+	memcpy(hd.magic,"JPBUNDLE",8);
+	hd.version=1;
+	hd.intpcount=intpcount;
+	hd.extpcount=extpcount;
+	hd.reserved[0]=symmetry;
 	
-	loadAllPolygons();
+	int anz=intpcount+extpcount;
+	BundleEntry* dir=new BundleEntry[anz+1];
+	memset(dir,0,(anz+1)*sizeof(BundleEntry));
 	
-	// Check A)
-	int erg=1;
-	LOGMSG("QC structure check: closed / colinear- and diagonal-free ... ");
-	for(int i=0;i<intpcount;i++) if (qcA(intp[i]) <= 0) { erg=0; break; }
-	if (erg>0) for(int i=0;i<extpcount;i++) if (qcA(extp[i]) <= 0) { erg=0; break; }
-	if (erg <=0) {
-		LOGMSG(" !! FAILED !!\n");
-		return 0;
+	#define BUNDLEPAD(OFF) ( ( (OFF) + BUNDLEALIGN - 1 ) / BUNDLEALIGN * BUNDLEALIGN )
+	
+	VLONG offset=BUNDLEPAD(sizeof(BundleHeader) + anz*sizeof(BundleEntry));
+	for(int i=0;i<anz;i++) {
+		Polygon& pg=( (i<intpcount) ? intp[i] : extp[i-intpcount] );
+		pg.ensureLoaded();
+		dir[i].nenner=pg.nenner;
+		dir[i].offset=offset;
+		dir[i].pointcount=pg.pointcount;
+		dir[i].xmin=pg.xmin;
+		dir[i].xmax=pg.xmax;
+		dir[i].ymin=pg.ymin;
+		dir[i].ymax=pg.ymax;
+		dir[i].cx0=(int)pg.cx0;
+		dir[i].cx1=(int)pg.cx1;
+		dir[i].cy0=(int)pg.cy0;
+		dir[i].cy1=(int)pg.cy1;
+		offset=BUNDLEPAD(offset + (VLONG)pg.pointcount*sizeof(PolygonPoint));
 	}
 	
-	LOGMSG("\n  PASSED\n");
+	fwrite(&hd,sizeof(hd),1,f);
+	fwrite(dir,sizeof(BundleEntry),anz,f);
+	
+	BYTE null[BUNDLEALIGN];
+	memset(null,0,BUNDLEALIGN);
+	VLONG pos=sizeof(BundleHeader) + anz*sizeof(BundleEntry);
+	for(int i=0;i<anz;i++) {
+		Polygon& pg=( (i<intpcount) ? intp[i] : extp[i-intpcount] );
+		fwrite(null,1,(size_t)(dir[i].offset-pos),f);
+		fwrite(pg.points,sizeof(PolygonPoint),pg.pointcount,f);
+		pos=dir[i].offset + (VLONG)pg.pointcount*sizeof(PolygonPoint);
+	}
+	
+	fclose(f);
+	delete[] dir;
+	
+	LOGMSG3("bundle %s written with %i interior ",afn,intpcount);
+	LOGMSG2("and %i exterior polygons\n",extpcount);
+	
+	return 1;
+}
 
-	// Check B
-	LOGMSG("QC image check: positioning / spacing / cross- and touch-free ");
-	for(int i=0;i<intpcount;i++) {
-		if (qcB(inbild,intp[i],COLORBLACK,INTPOLCOL) <= 0) { 
-			printf(" !! FAILED !!\n");
-			return 0;
+int mapBundle(
+	const char* afn,
+	Polygon*& aintp,int& aintpcount,
+	Polygon*& aextp,int& aextpcount,
+	int* asymmetry
+) {
+	// maps the bundle read-only, the polygons' vertex
+	// arrays point directly into the mapping. The mapping
+	// stays until the program ends
+	// asymmetry: if given, receives the stored SYM_ value
+	const BYTE* basis=NULL;
+	VLONG flen=0;
+	
+	#ifdef _WIN32
+	HANDLE hf=CreateFileA(afn,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+	if (hf != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER li;
+		if (GetFileSizeEx(hf,&li)) flen=li.QuadPart;
+		HANDLE hm=CreateFileMappingA(hf,NULL,PAGE_READONLY,0,0,NULL);
+		if (hm) {
+			basis=(const BYTE*)MapViewOfFile(hm,FILE_MAP_READ,0,0,0);
+			CloseHandle(hm);
+		}
+		CloseHandle(hf);
+	}
+	#else
+	int fd=open(afn,O_RDONLY);
+	if (fd >= 0) {
+		struct stat st;
+		if (fstat(fd,&st) == 0) flen=st.st_size;
+		if (flen > 0) {
+			void* m=mmap(NULL,(size_t)flen,PROT_READ,MAP_SHARED,fd,0);
+			if (m != MAP_FAILED) basis=(const BYTE*)m;
 		}
+		close(fd);
 	}
+	#endif
 	
-	for(int i=0;i<extpcount;i++) {
-		if (qcB(inbild,extp[i],COLORWHITE,EXTPOLCOL) <= 0) { 
-			printf(" !! FAILED !!\n");
+	if (!basis) {
+		LOGMSG2("\nERROR. Cannot map bundle %s.\n",afn);
+		return 0;
+	}
+	
+	const BundleHeader* hd=(const BundleHeader*)basis;
+	if (
+		(flen < (VLONG)sizeof(BundleHeader)) ||
+		(memcmp(hd->magic,"JPBUNDLE",8) != 0) ||
+		(hd->version != 1) ||
+		(hd->intpcount < 0) || (hd->extpcount < 0) ||
+		(hd->intpcount > MAXPOLYGONE) || (hd->extpcount > MAXPOLYGONE) ||
+		(hd->reserved[0] < SYM_NONE) || (hd->reserved[0] > SYM_CONJ) ||
+		(flen < (VLONG)(sizeof(BundleHeader) + (hd->intpcount+hd->extpcount)*sizeof(BundleEntry)))
+	) {
+		LOGMSG2("\nERROR. %s is no valid polygon bundle.\n",afn);
+		return 0;
+	}
+	
+	const BundleEntry* dir=(const BundleEntry*)(basis + sizeof(BundleHeader));
+	
+	if (aintp) delete[] aintp;
+	if (aextp) delete[] aextp;
+	aintpcount=hd->intpcount;
+	aextpcount=hd->extpcount;
+	if (asymmetry) *asymmetry=hd->reserved[0];
+	aintp=new Polygon[maximumI(aintpcount,1)];
+	aextp=new Polygon[maximumI(aextpcount,1)];
+	
+	for(int i=0;i<(aintpcount+aextpcount);i++) {
+		Polygon& pg=( (i<aintpcount) ? aintp[i] : aextp[i-aintpcount] );
+		const BundleEntry& be=dir[i];
+		if (
+			(be.pointcount < 0) ||
+			((be.offset % BUNDLEALIGN) != 0) ||
+			((be.offset + (VLONG)be.pointcount*(VLONG)sizeof(PolygonPoint)) > flen)
+		) {
+			LOGMSG3("\nERROR. Bundle %s: entry %i out of range.\n",afn,i);
 			return 0;
 		}
+		pg.mapped=1;
+		pg.points=(PolygonPoint*)(basis + be.offset);
+		pg.pointcount=be.pointcount;
+		pg.memused=be.pointcount;
+		pg.nenner=be.nenner;
+		pg.xmin=be.xmin;
+		pg.xmax=be.xmax;
+		pg.ymin=be.ymin;
+		pg.ymax=be.ymax;
+		pg.cx0=be.cx0;
+		pg.cx1=be.cx1;
+		pg.cy0=be.cy0;
+		pg.cy1=be.cy1;
 	}
 	
-	// now all polygons are drawn in their color
-	// and they don't cross each other or touch
-	// the boundary
-	// do they touch one another ?
+	return 1;
+}
+
+int polygonsToBundle(void) {
+	// text files (with POLYPATH prefix) -> bundle
+	loadPolygons(polypath,intp,intpcount,extp,extpcount);
+	symmetry=loadSymmetry(polypath);
+	if ( (intpcount<=0) && (extpcount<=0) ) {
+		LOGMSG("\n\nERROR. No polygons loaded.\n");
+		return 0;
+	}
+	int erg=writeBundle(bundlefn);
 	
+	delete[] intp;
+	delete[] extp;
+	intp=extp=NULL;
 	
-	printf(".");
-	// go over all polygons again and follow their
-	// edges. Check whether there are the right
-	// count of polygon colored pixels and free ones
-	// so that polygons do not touch each other
+	return erg;
+}
+
+int bundleToPolygons(void) {
+	// bundle -> text files (with POLYPATH prefix)
+	if (mapBundle(bundlefn,intp,intpcount,extp,extpcount,&symmetry) <= 0) return 0;
+	if (symmetry != SYM_NONE) saveSymmetry(polypath,symmetry);
+	
+	char tmp[2048];
 	for(int i=0;i<intpcount;i++) {
-		if (qcB2(inbild,intp[i],COLORBLACK,INTPOLCOL) <= 0) {
-			LOGMSG("FAILED.");
-			return 0;
-		}
+		sprintf(tmp,"%sintpoly%04i",polypath,i);
+		intp[i].save(tmp);
 	}
 	for(int i=0;i<extpcount;i++) {
-		if (qcB2(inbild,extp[i],COLORWHITE,EXTPOLCOL) <= 0) {
-			LOGMSG("FAILED.");
-			return 0;
-		}
+		sprintf(tmp,"%sextpoly%04i",polypath,i);
+		extp[i].save(tmp);
 	}
-		
-	LOGMSG("\n  PASSED\n");
+	LOGMSG3("%i interior and %i exterior polygon files written\n",intpcount,extpcount);
+	
+	delete[] intp;
+	delete[] extp;
+	intp=extp=NULL;
+	
+	return 1;
+}
 
-	// C-Test
-	// bitmap-driven oracle test
-	// every non-white pixel must lie on the exterior
-	// of at least ONE exterior polygon
-	// every non-black pixel must lie outside ALL
-	// interior polygons
+void loadPolygons(
+	const char* aprefix,
+	Polygon*& aintp,int& aintpcount,
+	Polygon*& aextp,int& aextpcount,
+	const int alazy
+) {
+	// files aprefix+intpolyNNNN and aprefix+extpolyNNNN
+	// alazy>0: only headers, vertices on first use
+	if (aextp) delete[] aextp;
+	if (aintp) delete[] aintp;
 	
-	int noch=1;
-	int noch0;
-	if (inbild.ylen <= 4096) noch0=inbild.ylen >> 3;
-	else noch0=inbild.ylen >> 4;
+	aextpcount=0;
+	aintpcount=0;
+	aextp=new Polygon[MAXPOLYGONE];
+	aintp=new Polygon[MAXPOLYGONE];
 	
-	LOGMSG("QC oracle check: where do pixels lie with respect to polygon ");
+	int searche=1,searchi=1;
+	char tmp[2048];
 	
-	for(int y=0;y<inbild.ylen;y++) {
-		double py=y*skalaRangeProPixel + RANGE0;
-		if ( (--noch) <= 0) {
-			printf("%I64lld ",inbild.ylen-y);
-			noch=noch0;
+	if (alazy <= 0) {
+		// discover the consecutively numbered files, then
+		// read and parse them on all threads
+		int ni=0,ne=0;
+		sprintf(tmp,"%sintpoly%04i",aprefix,ni);
+		while ( (ni<MAXPOLYGONE) && (fileExists(tmp)>0) ) {
+			ni++;
+			sprintf(tmp,"%sintpoly%04i",aprefix,ni);
+		}
+		sprintf(tmp,"%sextpoly%04i",aprefix,ne);
+		while ( (ne<MAXPOLYGONE) && (fileExists(tmp)>0) ) {
+			ne++;
+			sprintf(tmp,"%sextpoly%04i",aprefix,ne);
 		}
 		
-		for(int x=0;x<inbild.xlen;x++) {
-			double px=x*skalaRangeProPixel + RANGE0;
+		int tc=getThreadCount();
+		std::vector<char>* puffer=new std::vector<char>[tc];
+		char (*fehler)[1024]=new char[ni+ne][1024];
+		for(int i=0;i<(ni+ne);i++) fehler[i][0]=0;
+		
+		parallelIndex(ni+ne,[&](const int idx,const int t) {
+			char fn[2048];
+			Polygon* pg;
+			if (idx < ni) {
+				sprintf(fn,"%sintpoly%04i",aprefix,idx);
+				pg=&aintp[idx];
+			} else {
+				sprintf(fn,"%sextpoly%04i",aprefix,idx-ni);
+				pg=&aextp[idx-ni];
+			}
 			
-			// exterior polygons
-			if (inbild.getPoint(x,y) != COLORWHITE) {
-				int tmp=intpcount;
-				intpcount=0; 
-				// temporary no interior polygons present
-				// since only interested in functionality of exterior polygons here
-				if (jsoracle(px,py) == PIP_EXTERIOR) {
-					LOGMSG3("\n\nERROR. Exterior polygon tested wrong on image coordinates %i,%i\n",x,y);
-					drawAllPolygons(inbild);
-					drawCrossing(&inbild,x,y,COLORRED);
-					inbild.saveAsBmp("_ERROR_quality.bmp");
-					return 0;
-				}
-				intpcount=tmp;
+			FILE *f=fopen(fn,"rb");
+			if (!f) {
+				sprintf(fehler[idx],"ERROR. Polygon file %s cannot be read.\n",fn);
+				return;
 			}
+			fseek(f,0,SEEK_END);
+			long len=ftell(f);
+			fseek(f,0,SEEK_SET);
+			if (len < 0) len=0;
+			std::vector<char>& b=puffer[t];
+			if ((long)b.size() < (len+1)) b.resize(len+1);
+			len=(long)fread(b.data(),1,len,f);
+			b[len]=0;
+			fclose(f);
 			
-			// interier Polygons
-			if (inbild.getPoint(x,y) != COLORBLACK) {
-				int tmp=extpcount;
-				extpcount=0; 
-				// temporary no interior polygons
-				if (jsoracle(px,py) == PIP_INTERIOR) {
-					LOGMSG3("\n\nERROR. Interior polygon tested wrong on image coordinates %i,%i\n",x,y);
-					drawAllPolygons(inbild);
-					drawCrossing(&inbild,x,y,COLORRED);
-					inbild.saveAsBmp("_ERROR_quality.bmp");
-					return 0;
-				}
-				extpcount=tmp;
+			pg->parseText(b.data(),b.data()+len,fehler[idx]);
+		});
+		
+		for(int i=0;i<(ni+ne);i++) {
+			if (fehler[i][0]) {
+				LOGMSG2("%s",fehler[i]);
+				exit(99);
 			}
-		} // x
-	} // y
-	
-	unPrepareYOracle();
-	LOGMSG("\n  PASSED\n");
-	LOGMSG("    i.e. no non-white pixel is judged as exterior\n");
-	LOGMSG("    and  no non-black pixel is judged as interior\n");
-	
-	inbild.saveAsBmp("_FINAL_all_polygons.bmp");
-
-	printf("\n\nadding to small image ...");
-	double px,py;
-	for(int y=0;y<SMALLLEN;y++) {
-		py=(y+0.23)*smallskala + sm0;
+		}
 		
-		prepareYOracle(py);
+		delete[] fehler;
+		delete[] puffer;
+		aintpcount=ni;
+		aextpcount=ne;
 		
-		for(int x=0;x<SMALLLEN;x++) {
-			if (small.getPoint(x,y) != COLORGRAY) continue;
-			px=(x+0.23)*smallskala + sm0;
-			int erg=jsoracle(px,py);
-			
-			switch (erg) {
-				case PIP_EXTERIOR: small.setPoint(x,y,COLORWHITE); break;
-				case PIP_INTERIOR: small.setPoint(x,y,COLORBLACK); break;
-				case PIP_UNKNOWN: small.setPoint(x,y,COLORGRAY); break;
-				default: LOGMSG("\n\nERROR. Small. jsOracle.\n"); return 0;
+		return;
+	}
+	
+	while ( (searche>0) || (searchi>0) ) {
+		if (searchi>0) {
+			sprintf(tmp,"%sintpoly%04i",aprefix,aintpcount);
+			int erg=(alazy>0 ? aintp[aintpcount].loadHeader(tmp) : aintp[aintpcount].load(tmp));
+			if (erg <= 0) searchi=0; else {
+				aintpcount++;
+			}
+		}
+		
+		if (searche>0) {
+			sprintf(tmp,"%sextpoly%04i",aprefix,aextpcount);
+			int erg=(alazy>0 ? aextp[aextpcount].loadHeader(tmp) : aextp[aextpcount].load(tmp));
+			if (erg <= 0) searche=0; else {
+				aextpcount++;
 			}
 		}
 	}
-	unPrepareYOracle();
+}
 
-	delete[] intp;
-	delete[] extp;
-	
-	if (allvalid>0) {
-		LOGMSG3("\n=========================================================\n\nVALID: Quality control: all consecutively numbered %i interior and %i exterior polygons passed the tests.\n\n=========================================================\n",intpcount,extpcount);
-		small.saveAsBmp("_QC_passed_small_result.bmp");
-		return 1;
-	} else {
-		LOGMSG("\nFAILURE: Quality control: set of polygons NOT USABLE.\n");
-		return 0;
-	}
+
+int fileExists(const char* afn) {
+	struct stat st;
+	if (stat(afn,&st) != 0) return 0;
 	
-	return allvalid;
+	return 1;
 }
 
-int borderPresent(Charmap& md) {
-	// image must have a white border. 
-	int D=BORDERWIDTH;
-	
-	int border=1;
-	// as image is quadratic, x/y can be interchanged
-	for(int a=0;a<D;a++) {
-		for(int b=0;b<md.xlen;b++) {
-			if (
-				(md.getPoint(a,b) != COLORWHITE) ||
-				(md.getPoint(md.xlen-1-a,b) != COLORWHITE) ||
-				(md.getPoint(b,a) != COLORWHITE) ||
-				(md.getPoint(b,md.ylen-1-a) != COLORWHITE)
-			) {
-				border=0;
-				break;
-			}
-		}
-		
-		if (border<=0) break;
-	} // 
+
+// struct OracleCounters
+
+OracleCounters::OracleCounters() {
+	for(int i=0;i<4;i++) verdict[i]=0;
+	polygons=bboxrejects=pipcalls=edges=boundary=earlyexits=0;
+}
+
+void OracleCounters::add(const OracleCounters& a) {
+	for(int i=0;i<4;i++) verdict[i] += a.verdict[i];
+	polygons += a.polygons;
+	bboxrejects += a.bboxrejects;
+	pipcalls += a.pipcalls;
+	edges += a.edges;
+	boundary += a.boundary;
+	earlyexits += a.earlyexits;
+}
+
+#ifdef ORACLECOUNTERS
+CounterSlot::~CounterSlot() {
+	std::lock_guard<std::mutex> lock(countermutex);
+	countertotal.add(c);
+}
+#endif
+
+#ifdef ORACLECOUNTERS
+void writeOracleCounters(FILE* f,const int aeigene) {
+	// sum of the finished threads as JSON, with aeigene>0
+	// plus the (still running) calling thread
+	OracleCounters s;
+	{
+		std::lock_guard<std::mutex> lock(countermutex);
+		s.add(countertotal);
+	}
+	if (aeigene > 0) s.add(counterslot.c);
 	
-	return border;
+	fprintf(f,"{\n");
+	fprintf(f,"\t\"queries\": { \"interior\": %lld, \"exterior\": %lld, \"unknown\": %lld },\n",
+		(long long)s.verdict[PIP_INTERIOR],(long long)s.verdict[PIP_EXTERIOR],(long long)s.verdict[PIP_UNKNOWN]);
+	fprintf(f,"\t\"polygons_visited\": %lld,\n",(long long)s.polygons);
+	fprintf(f,"\t\"bbox_rejects\": %lld,\n",(long long)s.bboxrejects);
+	fprintf(f,"\t\"pip_calls\": %lld,\n",(long long)s.pipcalls);
+	fprintf(f,"\t\"edges_walked\": %lld,\n",(long long)s.edges);
+	fprintf(f,"\t\"boundary_hits\": %lld,\n",(long long)s.boundary);
+	fprintf(f,"\t\"stencil_early_exits\": %lld\n",(long long)s.earlyexits);
+	fprintf(f,"}\n");
 }
+#else
+void writeOracleCounters(FILE* f,const int /*aeigene*/) {
+	fprintf(f,"{ \"counters\": \"not compiled in, build with -DORACLECOUNTERS\" }\n");
+}
+#endif
 
-// main entry
+void oracleCountersAtExit(void) {
+	// the main thread's counters are already added, as
+	// thread-local objects are destroyed before exit handlers run
+	FILE *f=fopen("_oracle_counters.json","wt");
+	if (!f) return;
+	writeOracleCounters(f,0);
+	fclose(f);
+}
+
+// struct PolygonSet
+
+PolygonSet::PolygonSet() {
+	intp=extp=NULL;
+	intpcount=extpcount=0;
+	symmetry=SYM_NONE;
+}
+
+PolygonSet::~PolygonSet() {
+	if (intp) delete[] intp;
+	if (extp) delete[] extp;
+}
+
+void PolygonSet::load(const char* aprefix,const int alazy) {
+	loadPolygons(aprefix,intp,intpcount,extp,extpcount,alazy);
+	symmetry=loadSymmetry(aprefix);
+}
+
+void qcOracleError(const int aext,const int x,const int y) {
+	// C-test failure: message and _ERROR_quality.bmp drawn
+	// with the polygon kind under test only
+	int merkint=intpcount,merkext=extpcount;
+	if (aext > 0) intpcount=0; else extpcount=0;
+	if (aext > 0) {
+		LOGMSG3("\n\nERROR. Exterior polygon tested wrong on image coordinates %i,%i\n",x,y);
+	} else {
+		LOGMSG3("\n\nERROR. Interior polygon tested wrong on image coordinates %i,%i\n",x,y);
+	}
+	drawAllPolygons(inbild);
+	drawCrossing(&inbild,x,y,COLORRED);
+	inbild.saveAsBmp("_ERROR_quality.bmp");
+	intpcount=merkint;
+	extpcount=merkext;
+}
+
+int qcPixelVerdict(const int x,const int y) {
+	// C-test on one pixel: 1 if non-white and judged exterior,
+	// 0 if non-black and judged interior, -1 if fine
+	double px=x*skalaRangeProPixel + RANGE0;
+	double py=y*skalaRangeProPixel + RANGE0;
+	BYTE f=inbild.getPoint(x,y);
+
+	// non-white pixel judged exterior by the exterior polygons
+	if ( (f != COLORWHITE) && (jsoracleExteriorOnly(px,py) == PIP_EXTERIOR) ) return 1;
+	// non-black pixel judged interior by the interior polygons
+	if ( (f != COLORBLACK) && (jsoracleInteriorOnly(px,py) == PIP_INTERIOR) ) return 0;
+	return -1;
+}
+
+int qcOracleOwner(const int aext,const int x,const int y) {
+	// the polygon whose verdict fails the C-test at pixel x,y
+	// (as in qcPixelVerdict), -1 if none on its own
+	double px=x*skalaRangeProPixel + RANGE0;
+	double py=y*skalaRangeProPixel + RANGE0;
+	if (aext > 0) {
+		for(int i=0;i<extpcount;i++) {
+			if (jsoracleWith(NULL,0,&extp[i],1,px,py) == PIP_EXTERIOR) return i;
+		}
+	} else {
+		for(int i=0;i<intpcount;i++) {
+			if (jsoracleWith(&intp[i],1,NULL,0,px,py) == PIP_INTERIOR) return i;
+		}
+	}
+	return -1;
+}
+
+int qcSampleTest(const int aanz) {
+	// first tier of QCMODE=TIERED: the C-test on a random
+	// sample of about aanz pixels. The rows are split into
+	// bands, one random row per band, and in that row half of
+	// the pixels are drawn from the gray ones, a third from
+	// black/white pixels next to another colour, the rest from
+	// the others - errors sit where the colour changes. Run on
+	// the image before any polygon is drawn, a failure here is
+	// a failure of the full test as well. Same seed every run
+	int cystart=( (symmetry != SYM_NONE) ? (inbild.ylen >> 1) : 0 );
+	int anzrows=inbild.ylen-cystart;
+	const int PROZEILE=64;
+	int baender=maximumI(1,minimumI(anzrows,aanz / PROZEILE));
+	int proband=maximumI(1,aanz / baender);
+
+	std::atomic<int> fehlery(0x7FFFFFFF);
+	int fehlerx=0,fehlerart=-1;
+	std::mutex fehlermutex;
+	std::atomic<VLONG> anzgrau(0),anzrand(0),anzrest(0);
+
+	parallelIndex(baender,[&](const int k,const int /*t*/) {
+		unsigned long long state=0x51435341ULL + (unsigned long long)k*0x9E3779B97F4A7C15ULL;
+		int y0=cystart + (int)((VLONG)k*anzrows/baender);
+		int y1=cystart + (int)((VLONG)(k+1)*anzrows/baender);
+		int y=y0 + (int)(benchRandom(state) % (unsigned long long)maximumI(1,y1-y0));
+		if (y > fehlery) return;
+
+		// strata of the row
+		std::vector<int> strata[3];
+		for(int x=0;x<inbild.xlen;x++) {
+			BYTE f=inbild.getPoint(x,y);
+			if ( (f != COLORWHITE) && (f != COLORBLACK) ) {
+				strata[0].push_back(x);
+				continue;
+			}
+			int rand=0;
+			for(int dy=-1;((rand<=0)&&(dy<=1));dy++) {
+				int ny=y+dy;
+				if ( (ny < 0) || (ny >= inbild.ylen) ) continue;
+				for(int ddx=-1;ddx<=1;ddx++) {
+					int nx=x+ddx;
+					if ( (nx < 0) || (nx >= inbild.xlen) ) continue;
+					if (inbild.getPoint(nx,ny) != f) {
+						rand=1;
+						break;
+					}
+				}
+			}
+			strata[(rand>0) ? 1 : 2].push_back(x);
+		}
+
+		// quota 1/2, 1/3, rest; what a stratum cannot use
+		// goes to the next one
+		int quote[3];
+		quote[0]=proband >> 1;
+		quote[1]=proband / 3;
+		quote[2]=proband-quote[0]-quote[1];
+		int uebrig=0;
+		int fx=-1,art=-1;
+		for(int s=0;s<3;s++) {
+			std::vector<int>& st=strata[s];
+			int n=minimumI(quote[s]+uebrig,(int)st.size());
+			uebrig=quote[s]+uebrig-n;
+			if (s == 0) anzgrau += n; else if (s == 1) anzrand += n; else anzrest += n;
+			// partial Fisher-Yates: n distinct pixels
+			for(int i=0;i<n;i++) {
+				int j=i + (int)(benchRandom(state) % (unsigned long long)(st.size()-i));
+				int tmp=st[i]; st[i]=st[j]; st[j]=tmp;
+				int a=qcPixelVerdict(st[i],y);
+				if ( (a >= 0) && ( (art < 0) || (st[i] < fx) ) ) {
+					art=a;
+					fx=st[i];
+				}
+			}
+		}
+
+		if (art >= 0) {
+			std::lock_guard<std::mutex> lock(fehlermutex);
+			if ( (y < fehlery) || ( (y == fehlery) && (fx < fehlerx) ) ) {
+				fehlery=y;
+				fehlerx=fx;
+				fehlerart=art;
+			}
+		}
+	});
+
+	char tmp[1024];
+	sprintf(tmp,"%lld pixels in %i rows (gray %lld, next to another colour %lld, other %lld) ",
+		(long long)(anzgrau+anzrand+anzrest),baender,(long long)anzgrau,(long long)anzrand,(long long)anzrest);
+	LOGMSG2("%s",tmp);
+
+	if (fehlerart >= 0) {
+		qcOracleError(fehlerart,fehlerx,fehlery);
+		return 0;
+	}
+
+	return 1;
+}
+
+unsigned long long qcInputHash(void) {
+	// everything the verdict of the QC depends on: range,
+	// symmetry, the polygons' vertices and the image pixels
+	// (before any polygon is drawn into it)
+	unsigned long long h=FNVSTART;
+	h=fnv1a(h,&RANGE0,sizeof(RANGE0));
+	h=fnv1a(h,&RANGE1,sizeof(RANGE1));
+	h=fnv1a(h,&symmetry,sizeof(symmetry));
+	h=fnv1a(h,&intpcount,sizeof(intpcount));
+	h=fnv1a(h,&extpcount,sizeof(extpcount));
+	for(int j=0;j<(intpcount+extpcount);j++) {
+		Polygon& pg=( (j<intpcount) ? intp[j] : extp[j-intpcount] );
+		pg.ensureLoaded();
+		h=fnv1a(h,&pg.nenner,sizeof(pg.nenner));
+		h=fnv1a(h,&pg.pointcount,sizeof(pg.pointcount));
+		h=fnv1a(h,pg.points,(VLONG)pg.pointcount*sizeof(PolygonPoint));
+	}
+	h=fnv1a(h,&inbild.xlen,sizeof(inbild.xlen));
+	h=fnv1a(h,&inbild.ylen,sizeof(inbild.ylen));
+	h=qcImageHash(h,inbild,0,0,inbild.xlen-1,inbild.ylen-1);
+
+	return h;
+}
+
+unsigned long long qcPolygonHash(Polygon& apg,const int aext) {
+	// vertices plus what maps them to pixels
+	unsigned long long h=FNVSTART;
+	h=fnv1a(h,&RANGE0,sizeof(RANGE0));
+	h=fnv1a(h,&RANGE1,sizeof(RANGE1));
+	h=fnv1a(h,&symmetry,sizeof(symmetry));
+	h=fnv1a(h,&inbild.xlen,sizeof(inbild.xlen));
+	h=fnv1a(h,&inbild.ylen,sizeof(inbild.ylen));
+	h=fnv1a(h,&aext,sizeof(aext));
+	apg.ensureLoaded();
+	h=fnv1a(h,&apg.nenner,sizeof(apg.nenner));
+	h=fnv1a(h,&apg.pointcount,sizeof(apg.pointcount));
+	h=fnv1a(h,apg.points,(VLONG)apg.pointcount*sizeof(PolygonPoint));
+
+	return h;
+}
+
+void qcPixelBox(Polygon& apg,const int amargin,int& x0,int& y0,int& x1,int& y1) {
+	// pixels of the vertices, grown by amargin, in the image
+	x0=y0=0x7FFFFFFF;
+	x1=y1=-0x7FFFFFFF;
+	for(int i=0;i<apg.pointcount;i++) {
+		int xx=inbildcoord( (double)apg.points[i].x / apg.nenner);
+		int yy=inbildcoord( (double)apg.points[i].y / apg.nenner);
+		if (xx < x0) x0=xx;
+		if (xx > x1) x1=xx;
+		if (yy < y0) y0=yy;
+		if (yy > y1) y1=yy;
+	}
+	x0=maximumI(0,x0-amargin);
+	y0=maximumI(0,y0-amargin);
+	x1=minimumI((int)inbild.xlen-1,x1+amargin);
+	y1=minimumI((int)inbild.ylen-1,y1+amargin);
+}
+
+unsigned long long qcImageHash(unsigned long long h,Charmap& md,const int x0,const int y0,const int x1,const int y1) {
+	// row by row in row order, the same for either layout
+	if (x1 < x0) return h;
+	std::vector<BYTE> z(x1-x0+1);
+	for(int y=y0;y<=y1;y++) {
+		md.getRow(y,x0,x1,&z[0]);
+		h=fnv1a(h,&z[0],x1-x0+1);
+	}
+	return h;
+}
+
+int qcOracleMargin(Polygon& apg) {
+	// pixels around the vertices' box in which the polygon
+	// can judge a pixel interior: the oracle's 5x5 stencil
+	// plus rounding
+	return (int)ceil( 3.0 / (apg.nenner*skalaRangeProPixel) ) + 1;
+}
+
+int qcCacheOracleMode(QcCache& acache,std::vector<unsigned long long>& akeyc,const unsigned long long akeyx) {
+	// 0: nothing to test, 2: the changed interior polygons in
+	// their boxes, 1: full test. The interior verdict is the
+	// union over the interior polygons, so it is checked per
+	// polygon; the exterior one needs all exterior polygons
+	// at once and is only kept if none of them and no pixel
+	// changed. Symmetric sets fold rows, always full test
+	if (symmetry != SYM_NONE) return 1;
+	if (acache.has(QCCACHE_EXTERIOR,akeyx) <= 0) return 1;
+	VLONG flaeche=0;
+	int anz=0;
+	for(int j=0;j<intpcount;j++) {
+		if (acache.has(QCCACHE_ORACLE,akeyc[j]) > 0) continue;
+		int x0,y0,x1,y1;
+		qcPixelBox(intp[j],qcOracleMargin(intp[j]),x0,y0,x1,y1);
+		flaeche += (VLONG)(x1-x0+1)*(y1-y0+1);
+		anz++;
+	}
+	if (anz <= 0) return 0;
+	// boxes are tested pixel by pixel, the full test by rows
+	if (flaeche*4 > inbild.xlen*inbild.ylen) return 1;
+	char tmp[1024];
+	sprintf(tmp,"(%i changed interior polygons, in their boxes) ",anz);
+	LOGMSG2("%s",tmp);
+	return 2;
+}
+
+int qcOracleBoxes(QcCache& acache,std::vector<unsigned long long>& akeyc) {
+	// C-test, interior part, for the interior polygons not in
+	// the cache: within its box no non-black pixel may be
+	// judged interior by the polygon. Lowest (y,x) reported
+	std::vector<std::pair<int,int> > aufgaben; // polygon,row
+	std::vector<int> bx0(intpcount),bx1(intpcount);
+	for(int j=0;j<intpcount;j++) {
+		if (acache.has(QCCACHE_ORACLE,akeyc[j]) > 0) continue;
+		int y0,y1;
+		qcPixelBox(intp[j],qcOracleMargin(intp[j]),bx0[j],y0,bx1[j],y1);
+		for(int y=y0;y<=y1;y++) aufgaben.push_back(std::make_pair(j,y));
+	}
+	std::atomic<int> fehlery(0x7FFFFFFF);
+	int fehlerx=0;
+	std::mutex fehlermutex;
+	parallelIndex((int)aufgaben.size(),[&](const int k,const int /*t*/) {
+		int j=aufgaben[k].first;
+		int y=aufgaben[k].second;
+		if (y > fehlery) return;
+		double py=y*skalaRangeProPixel + RANGE0;
+		for(int x=bx0[j];x<=bx1[j];x++) {
+			if (inbild.getPoint(x,y) == COLORBLACK) continue;
+			double px=x*skalaRangeProPixel + RANGE0;
+			if (jsoracleWith(&intp[j],1,NULL,0,px,py) != PIP_INTERIOR) continue;
+			std::lock_guard<std::mutex> lock(fehlermutex);
+			if ( (y < fehlery) || ( (y == fehlery) && (x < fehlerx) ) ) {
+				fehlery=y;
+				fehlerx=x;
+			}
+			break;
+		}
+	});
+	if (fehlery < 0x7FFFFFFF) {
+		qcOracleError(0,fehlerx,fehlery);
+		return 0;
+	}
+
+	return 1;
+}
+
+int qcOracleTest(QcCheckpoint* cp,QcReport* sammler,const int apart,const int aparts,int* afehler) {
+	// the full C-test over all image rows (see qualitycontrol).
+	// 0: failed, message and _ERROR_quality.bmp written.
+	// SHARD: only the apart-th of aparts blocks of rows, and
+	// with afehler the failure (kind,x,y, kind -1 if none) is
+	// returned there instead of reported
+	int noch0;
+	if (inbild.ylen <= 4096) noch0=inbild.ylen >> 3;
+	else noch0=inbild.ylen >> 4;
+
+	// symmetric set: the mirrored half answers through the
+	// stored one. A lower half pixel's corner folds onto the
+	// upper left corner of its mirror pixel, not the lower left
+	// one tested there. But check B keeps every polygon edge at
+	// least one pixel away from any pixel of another colour, so
+	// no edge runs through a pixel and the verdict is the same
+	// at all its corners. With the image checked to be symmetric
+	// the upper half suffices
+	int cystart=( (symmetry != SYM_NONE) ? (inbild.ylen >> 1) : 0 );
+
+	// scanline C-test: per row all polygons are classified
+	// at once (ScanSet) instead of 2 oracle calls per pixel.
+	// Same verdicts, needs one common denominator
+	int tc=getThreadCount();
+	ScanSet* scan=NULL;
+	ScanCursor** cursors=NULL;
+	std::vector<int> scangx;
+	if (qctest == QCTEST_SCANLINE) {
+		scan=new ScanSet;
+		if (scan->init(intp,intpcount,extp,extpcount) <= 0) {
+			LOGMSG("(polygons with different denominators, pixel test) ");
+			delete scan;
+			scan=NULL;
+		} else {
+			LOGMSG("(scanline) ");
+			cursors=new ScanCursor*[tc];
+			for(int t=0;t<tc;t++) cursors[t]=new ScanCursor(scan);
+			scangx.resize(inbild.xlen);
+			for(int x=0;x<inbild.xlen;x++) {
+				double px=x*skalaRangeProPixel + RANGE0;
+				scangx[x]=(int)floor(px*scan->nenner);
+			}
+		}
+	}
+
+	// rows are distributed over the threads. Of all failures
+	// the lowest (y,x) is reported, as the serial test did, so
+	// the result does not depend on the thread schedule
+	int anzrows=inbild.ylen-cystart;
+	std::atomic<int> fehlery(0x7FFFFFFF);
+	int fehlerx=0,fehlerart=-1;
+	std::mutex fehlermutex;
+	std::atomic<int> rowsdone(0);
+	int k0=(int)((VLONG)apart*anzrows/aparts);
+	int k1=(int)((VLONG)(apart+1)*anzrows/aparts);
+	if (aparts > 1) {
+		cystart += k0;
+		anzrows=k1-k0;
+		noch0=maximumI(1,noch0/aparts);
+	}
+
+	parallelIndex(anzrows,[&](const int k,const int t) {
+		int y=cystart+k;
+		if (y > fehlery) return;
+		if ( (cp) && (cp->isDone(y) > 0) ) return;
+		double py=y*skalaRangeProPixel + RANGE0;
+		int fx=-1,art=-1;
+
+		std::vector<BYTE> scanint,scanext;
+		int zeilescan=( (scan) ? 1 : 0 );
+		if (zeilescan > 0) {
+			scanint.resize(inbild.xlen);
+			scanext.resize(inbild.xlen);
+			cursors[t]->classifyRow(py,&scangx[0],inbild.xlen,&scanint[0],&scanext[0]);
+		}
+		// collecting: runs of failing pixels of one kind, the
+		// polygon taken from the run's first pixel
+		int laufart=-1,laufx0=0;
+		for(int x=0;x<=inbild.xlen;x++) {
+			int a=-1;
+			if (x < inbild.xlen) {
+				if (zeilescan > 0) {
+					BYTE f=inbild.getPoint(x,y);
+					if ( (f != COLORWHITE) && (scanext[x] > 0) ) a=1;
+					else if ( (f != COLORBLACK) && (scanint[x] > 0) ) a=0;
+				} else a=qcPixelVerdict(x,y);
+			}
+			if (sammler) {
+				if (a == laufart) continue;
+				if (laufart >= 0) {
+					sammler->add(QCF_ORACLE,laufart,qcOracleOwner(laufart,laufx0,y),laufx0,y,x-1,y);
+				}
+				laufart=a;
+				laufx0=x;
+				continue;
+			}
+			if (a >= 0) {
+				art=a;
+				fx=x;
+				break;
+			}
+		} // x
+
+		if (art >= 0) {
+			std::lock_guard<std::mutex> lock(fehlermutex);
+			if (y < fehlery) {
+				fehlery=y;
+				fehlerx=fx;
+				fehlerart=art;
+			}
+		} else if (cp) cp->rowDone(y);
+		int d=++rowsdone;
+		if ( (d % noch0) == 0) printf("%i ",anzrows-d);
+	});
+
+	if (cursors) {
+		for(int t=0;t<tc;t++) delete cursors[t];
+		delete[] cursors;
+	}
+	if (scan) delete scan;
+	if (afehler) {
+		afehler[0]=fehlerart;
+		afehler[1]=( (fehlerart >= 0) ? fehlerx : 0 );
+		afehler[2]=( (fehlerart >= 0) ? (int)fehlery : 0 );
+		return (fehlerart >= 0) ? 0 : 1;
+	}
+	if (fehlerart >= 0) {
+		qcOracleError(fehlerart,fehlerx,fehlery);
+		return 0;
+	}
+
+	return 1;
+}
+
+int qcShard(void) {
+	// SHARD=i/n: this process checks the polygons j with
+	// j % n == i (structure, region, touch) and the i-th of n
+	// blocks of image rows of the oracle test. The region
+	// check sees all polygons through the overlay and the
+	// touch and oracle tests run on the image with all of
+	// them drawn, so every shard judges its part exactly as
+	// the single run does. A check runs only if the one before
+	// passed, the image and oracle checks only if the whole set
+	// passes the structure check. Nothing is reported,
+	// CMD=QCMERGE does that
+	loadAllPolygons();
+
+	QcShardResult res;
+	res.hash=qcInputHash();
+	res.shard=qcshard;
+	res.shards=qcshards;
+	int anzp=intpcount+extpcount;
+	int anzeigen=(anzp > qcshard) ? (anzp-qcshard+qcshards-1) / qcshards : 0;
+	char tmp[1024];
+	sprintf(tmp,"QC shard %i of %i: %i polygons, oracle rows block %i\n",qcshard,qcshards,anzeigen,qcshard);
+	LOGMSG2("%s",tmp);
+
+	LOGMSG("QC structure check ... ");
+	res.structure=-1;
+	for(int j=qcshard;j<anzp;j+=qcshards) {
+		if (qcA( (j >= intpcount) ? extp[j-intpcount] : intp[j]) > 0) continue;
+		res.structure=j;
+		break;
+	}
+	LOGMSG( (res.structure < 0) ? "\n  PASSED\n" : " !! FAILED !!\n");
+
+	// the image and oracle checks need every polygon closed
+	// and axis-parallel (a diagonal edge ends the pixel oracle),
+	// the other shards' ones as well. The structure check is
+	// cheap, so it is run on those too; a failure there is left
+	// to the shard owning the polygon, this one stops
+	int allepassen=( (res.structure == -1) ? 1 : 0 );
+	for(int j=0;((allepassen>0)&&(j<anzp));j++) {
+		if ( (j % qcshards) == qcshard) continue;
+		if (qcA( (j >= intpcount) ? extp[j-intpcount] : intp[j]) <= 0) allepassen=0;
+	}
+	if ( (res.structure == -1) && (allepassen <= 0) ) {
+		LOGMSG("QC image and oracle checks: not run, a polygon of another shard fails the structure check\n");
+	}
+
+	if (allepassen > 0) {
+		LOGMSG("QC image check ");
+		std::atomic<int> ersterfehler(anzp);
+		if (anzp >= QCNOOWNER) {
+			// too many polygons for the overlay's owner numbers:
+			// the serial way, every polygon drawn after its turn.
+			// The findings go to a report nobody reads, a shard
+			// reports nothing
+			QcReport still;
+			for(int j=0;j<anzp;j++) {
+				Polygon& pg=( (j < intpcount) ? intp[j] : extp[j-intpcount] );
+				if ( (j % qcshards) == qcshard) {
+					if (qcBRegion(inbild,pg,(j < intpcount) ? COLORBLACK : COLORWHITE,NULL,j,&still) <= 0) {
+						ersterfehler=j;
+						break;
+					}
+				}
+				qcBDraw(inbild,pg,(j < intpcount) ? INTPOLCOL : EXTPOLCOL);
+			}
+		} else {
+			QcOverlay* ov=new QcOverlay(inbild.xlen,inbild.ylen);
+			parallelIndex(anzp,[&](const int j,const int /*t*/) {
+				ov->drawPolygon( (j<intpcount) ? intp[j] : extp[j-intpcount],j );
+			});
+			printf(".");
+			parallelIndex(anzeigen,[&](const int k,const int /*t*/) {
+				int j=qcshard + k*qcshards;
+				if (j > ersterfehler) return;
+				int ok;
+				if (j < intpcount) ok=qcBRegion(inbild,intp[j],COLORBLACK,ov,j);
+				else ok=qcBRegion(inbild,extp[j-intpcount],COLORWHITE,ov,j);
+				if (ok <= 0) atomicMinI(ersterfehler,j);
+			});
+			delete ov;
+		}
+		printf(".");
+		res.region=( (ersterfehler < anzp) ? (int)ersterfehler : -1 );
+	}
+
+	if (res.region == -1) {
+		for(int j=0;j<anzp;j++) {
+			if (j < intpcount) qcBDraw(inbild,intp[j],INTPOLCOL);
+			else qcBDraw(inbild,extp[j-intpcount],EXTPOLCOL);
+		}
+		printf(".");
+		std::atomic<int> ersterfehler2(anzp);
+		parallelIndex(anzeigen,[&](const int k,const int /*t*/) {
+			int j=qcshard + k*qcshards;
+			if (j > ersterfehler2) return;
+			int ok;
+			if (j < intpcount) ok=qcB2(inbild,intp[j],COLORBLACK,INTPOLCOL,0);
+			else ok=qcB2(inbild,extp[j-intpcount],COLORWHITE,EXTPOLCOL,0);
+			if (ok <= 0) atomicMinI(ersterfehler2,j);
+		});
+		res.touch=( (ersterfehler2 < anzp) ? (int)ersterfehler2 : -1 );
+	}
+	if (allepassen > 0) {
+		LOGMSG( ( (res.region == -1) && (res.touch == -1) ) ? "\n  PASSED\n" : " !! FAILED !!\n");
+	}
+
+	if (res.touch == -1) {
+		LOGMSG("QC oracle check ");
+		int fehler[3];
+		qcOracleTest(NULL,NULL,qcshard,qcshards,fehler);
+		res.oracleart=fehler[0];
+		res.oraclex=fehler[1];
+		res.oracley=fehler[2];
+		unPrepareYOracle();
+		LOGMSG( (res.oracleart < 0) ? "\n  PASSED\n" : " !! FAILED !!\n");
+	}
+
+	char fn[1024];
+	sprintf(fn,QCSHARDFN,qcshard);
+	if (res.save(fn) <= 0) {
+		LOGMSG2("\nERROR. Cannot write %s.\n",fn);
+		return 0;
+	}
+	LOGMSG2("\nshard result written to %s, verdict by CMD=QCMERGE\n",fn);
+
+	delete[] intp;
+	delete[] extp;
+	intp=extp=NULL;
+
+	return 1;
+}
+
+int qcMerge(void) {
+	// combines _QC_shard_0.txt .. _QC_shard_<n-1>.txt and runs
+	// the quality control with their results: the cheap checks
+	// (symmetry, geometric, sample tier) are done here, the
+	// lowest failure of the shards is checked again the serial
+	// way for message and error image, a set without any ends
+	// with _FINAL_all_polygons.bmp, the small image and VALID
+	// as in a single run
+	QcShardResult alle;
+	char fn[1024];
+	sprintf(fn,QCSHARDFN,0);
+	if (alle.load(fn) <= 0) {
+		LOGMSG2("\nERROR. QCMERGE: cannot read %s.\n",fn);
+		return 0;
+	}
+	int n=alle.shards;
+	int fehlt=0;
+	for(int i=1;i<n;i++) {
+		QcShardResult b;
+		sprintf(fn,QCSHARDFN,i);
+		if (b.load(fn) <= 0) {
+			LOGMSG2("\nERROR. QCMERGE: shard result %s missing or unreadable.\n",fn);
+			fehlt++;
+			continue;
+		}
+		if ( (b.shards != n) || (b.shard != i) || (b.hash != alle.hash) ) {
+			LOGMSG2("\nERROR. QCMERGE: %s belongs to another run (shard count or inputs differ).\n",fn);
+			fehlt++;
+			continue;
+		}
+		alle.merge(b);
+	}
+	if (fehlt > 0) return 0;
+	if (alle.complete() <= 0) {
+		LOGMSG("\nERROR. QCMERGE: shard results are incomplete.\n");
+		return 0;
+	}
+	LOGMSG2("QCMERGE: results of %i shards\n",n);
+
+	// the verdict is reported by the single-run code
+	qcreport=QCREPORT_FIRST;
+	qccache=0;
+	qcresume=0;
+	qccheckpointsek=0;
+	qcmerged=&alle;
+	int erg=qualitycontrol();
+	qcmerged=NULL;
+
+	return erg;
+}
+
+void qcReportWrite(QcReport& arep) {
+	// QCREPORT=ALL verdict: the findings as CSV and boxed in
+	// the image as it is at that point
+	char tmp[1024];
+	sprintf(tmp,"\nFAILURE: Quality control: %lld findings, see _QC_report.csv and _QC_report.bmp.\n",
+		(long long)arep.anzahl);
+	LOGMSG2("%s",tmp);
+	if (arep.save("_QC_report.csv") <= 0) LOGMSG("\nERROR. Cannot write _QC_report.csv.\n");
+	arep.annotate(inbild);
+	inbild.saveAsBmp("_QC_report.bmp");
+}
+
+int qualitycontrol(void) {
+	// qcChecks returns as soon as the verdict is known, passed
+	// or failed, on whichever path. Then the checkpoint is done
+	// with (RESUME continues an interrupted run, not a judged
+	// one) and cache and report are freed. A checkpoint for
+	// other inputs is left alone (cp is NULL then)
+	QcCheckpoint* cp=NULL;
+	QcCache* cache=NULL;
+	QcReport* sammler=NULL;
+	int erg=qcChecks(cp,cache,sammler);
+	if (cp) {
+		delete cp;
+		remove(QCCHECKPOINTFN);
+	}
+	if (cache) delete cache;
+	if (sammler) delete sammler;
+
+	return erg;
+}
+
+int qcChecks(QcCheckpoint*& cp,QcCache*& cache,QcReport*& sammler) {
+	int allvalid=1;
+	Charmap small;
+	int SMALLLEN=512;
+	small.setlenxy(SMALLLEN,SMALLLEN);
+	setPaletteTo(small);
+	small.fill(COLORGRAY);
+	
+	// some non-power2 non-standard region
+	double mm=0.5*(RANGE0+RANGE1);
+	double br=0.783*(RANGE1-RANGE0);
+	double sm0=mm-br;
+	double sm1=mm+br;
+	double smallskala=(double)(sm1-sm0) / SMALLLEN;
+	
+	loadAllPolygons();
+	if ( (qcmerged) && (qcmerged->hash != qcInputHash()) ) {
+		LOGMSG("\nERROR. QCMERGE: polygons, image or range differ from the ones the shards checked.\n");
+		return 0;
+	}
+
+	// checkpoint: the phase reached and the finished oracle
+	// rows are saved now and then (CHECKPOINT=seconds), RESUME=1
+	// continues from there if the inputs are the same
+	int startphase=QCPHASE_STRUCTURE;
+	if ( (qcreport == QCREPORT_FIRST) && ( (qccheckpointsek > 0) || (qcresume > 0) ) ) {
+		cp=new QcCheckpoint;
+		cp->hash=qcInputHash();
+		cp->erledigt.assign(inbild.ylen,0);
+		if (qcresume > 0) {
+			QcCheckpoint alt;
+			if (alt.load(QCCHECKPOINTFN) <= 0) {
+				LOGMSG("RESUME: no usable checkpoint, QC starts from the beginning\n");
+			} else if ( (alt.hash != cp->hash) || ((int)alt.erledigt.size() != inbild.ylen) ) {
+				LOGMSG("\nERROR. RESUME: polygons, image or range differ from the ones the checkpoint was written for. Not resuming.\n");
+				delete cp;
+				cp=NULL;
+				return 0;
+			} else {
+				startphase=cp->phase=alt.phase;
+				cp->erledigt=alt.erledigt;
+				int anz=0;
+				for(int y=0;y<inbild.ylen;y++) anz += cp->erledigt[y];
+				char tmp[1024];
+				sprintf(tmp,"RESUME: continuing in phase %i, %i of %i image rows of the oracle test done\n",startphase,anz,(int)inbild.ylen);
+				LOGMSG2("%s",tmp);
+			}
+		}
+	} else if (qcresume > 0) {
+		LOGMSG("RESUME is not available with QCREPORT=ALL, QC starts from the beginning\n");
+	}
+
+	// QCCACHE=1: per polygon the keys of the checks it
+	// passed before. Structure: the vertices, region: plus the
+	// image around them, oracle: plus the image with all
+	// polygons drawn (after check B). The exterior part of the
+	// oracle test has one key for all exterior polygons and
+	// the whole image
+	int anzp=intpcount+extpcount;
+	std::vector<unsigned long long> keya,keyb,keyc;
+	unsigned long long keyx=FNVSTART;
+	if ( (qccache > 0) && (qcreport == QCREPORT_FIRST) ) {
+		cache=new QcCache;
+		cache->load(QCCACHEFN);
+		keya.resize(anzp);
+		keyb.resize(anzp);
+		int anzb=0;
+		for(int j=0;j<anzp;j++) {
+			int ext=( (j >= intpcount) ? 1 : 0 );
+			Polygon& pg=( (ext > 0) ? extp[j-intpcount] : intp[j] );
+			keya[j]=qcPolygonHash(pg,ext);
+			int x0,y0,x1,y1;
+			qcPixelBox(pg,2,x0,y0,x1,y1);
+			keyb[j]=qcImageHash(keya[j],inbild,x0,y0,x1,y1);
+			if (ext > 0) keyx=fnv1a(keyx,&keya[j],sizeof(keya[j]));
+			anzb += cache->has(QCCACHE_REGION,keyb[j]);
+		}
+		keyx=qcImageHash(keyx,inbild,0,0,(int)inbild.xlen-1,(int)inbild.ylen-1);
+		char tmp[1024];
+		sprintf(tmp,"QC cache: %i of %i polygons unchanged with their image region\n",anzb,anzp);
+		LOGMSG2("%s",tmp);
+	} else if (qccache > 0) {
+		LOGMSG("QCCACHE is not used with QCREPORT=ALL\n");
+	}
+
+	if (symmetry != SYM_NONE) {
+		// the stored half only answers for the other one
+		// if the image itself is symmetric
+		LOGMSG("QC symmetry check: image mirror-symmetric ... ");
+		if ( (RANGE0 != -RANGE1) || (imageSymmetric(inbild,symmetry) <= 0) ) {
+			LOGMSG(" !! FAILED !!\n");
+			return 0;
+		}
+		LOGMSG("\n  PASSED\n");
+	}
+	
+	// QCREPORT=ALL: the checks go on after a failure and
+	// collect every failing location, reported at the end
+	if (qcreport == QCREPORT_ALL) sammler=new QcReport;
+
+	if (startphase > QCPHASE_STRUCTURE) {
+		LOGMSG("QC structure and geometric checks: passed before (RESUME)\n");
+	} else {
+		// Check A)
+		int erg=1;
+		LOGMSG("QC structure check: closed / colinear- and diagonal-free ... ");
+		for(int j=0;j<(intpcount+extpcount);j++) {
+			int ext=( (j >= intpcount) ? 1 : 0 );
+			if ( (cache) && (cache->has(QCCACHE_STRUCTURE,keya[j]) > 0) ) continue;
+			// merging: only the shards' failure, for its message
+			if ( (qcmerged) && (j != qcmerged->structure) ) continue;
+			if (qcA( (ext > 0) ? extp[j-intpcount] : intp[j]) > 0) continue;
+			erg=0;
+			if (!sammler) break;
+			sammler->add(QCF_STRUCTURE,ext,(ext > 0) ? j-intpcount : j,-1,-1,-1,-1);
+		}
+		if ( (erg <=0) && (!sammler) ) {
+			LOGMSG(" !! FAILED !!\n");
+			return 0;
+		}
+
+		if (erg > 0) {
+			LOGMSG("\n  PASSED\n");
+			if (cache) {
+				for(int j=0;j<anzp;j++) cache->add(QCCACHE_STRUCTURE,keya[j]);
+				cache->save(QCCACHEFN);
+			}
+		} else {
+			LOGMSG("\n  FAILED (collected)\n");
+			// the other checks and the oracle need closed
+			// axis-parallel polygons (a diagonal edge ends the
+			// program there), so the report stops here
+			LOGMSG("QC image and oracle checks: not run, structure findings first\n");
+			qcReportWrite(*sammler);
+			return 0;
+		}
+
+		// geometric pre-check: fails fast on polygons that the
+		// raster check below would find too close to each other.
+		// Both fast tiers are left out when collecting. With the
+		// cache it is the spacing check for unchanged polygons
+		if ( ( (qcgeometric > 0) || (cache) ) && (!sammler) ) {
+			LOGMSG("QC geometric check: spacing between polygons ... ");
+			if (qcGeometric() <= 0) {
+				LOGMSG(" !! FAILED !!\n");
+				return 0;
+			}
+			LOGMSG("\n  PASSED\n");
+		}
+
+		// tiered: a sample of the C-test before the expensive
+		// bitmap and full oracle tests
+		if ( (qcmode == QCMODE_TIERED) && (!sammler) ) {
+			LOGMSG("QC sample check (tier 1): ");
+			if (qcSampleTest(qcsamples) <= 0) {
+				LOGMSG(" !! FAILED !!\n");
+				return 0;
+			}
+			LOGMSG("\n  PASSED\n");
+		}
+	}
+	if (cp) cp->advance(QCPHASE_BITMAP);
+
+	if (startphase > QCPHASE_BITMAP) {
+		// the oracle test needs the polygons drawn in
+		LOGMSG("QC image check: passed before (RESUME)\n");
+		for(int j=0;j<(intpcount+extpcount);j++) {
+			if (j < intpcount) qcBDraw(inbild,intp[j],INTPOLCOL);
+			else qcBDraw(inbild,extp[j-intpcount],EXTPOLCOL);
+		}
+	} else {
+		// Check B
+		LOGMSG("QC image check: positioning / spacing / cross- and touch-free ");
+		// all polygons are checked in parallel against an overlay
+		// that makes polygon j see the image as after drawing
+		// 0..j-1. The lowest failing polygon is then checked again
+		// the serial way on the image, so message and error image
+		// are the same as before
+		std::atomic<int> ersterfehler(anzp);
+		if (qcmerged) {
+			if (qcmerged->region >= 0) ersterfehler=qcmerged->region;
+		} else if (anzp >= QCNOOWNER) {
+			// too many polygons for the overlay's owner numbers:
+			// the serial way, polygon by polygon on the image
+			for(int j=0;j<anzp;j++) {
+				int ext=( (j >= intpcount) ? 1 : 0 );
+				Polygon& pg=( (ext > 0) ? extp[j-intpcount] : intp[j] );
+				BYTE relf=( (ext > 0) ? COLORWHITE : COLORBLACK );
+				BYTE polcol=( (ext > 0) ? EXTPOLCOL : INTPOLCOL );
+				if (sammler) qcBRegion(inbild,pg,relf,NULL,j,sammler);
+				else if ( (!cache) || (cache->has(QCCACHE_REGION,keyb[j]) <= 0) ) {
+					if (qcB(inbild,pg,relf,polcol) <= 0) {
+						printf(" !! FAILED !!\n");
+						return 0;
+					}
+				}
+				qcBDraw(inbild,pg,polcol);
+			}
+		} else {
+			QcOverlay* ov=new QcOverlay(inbild.xlen,inbild.ylen);
+			parallelIndex(anzp,[&](const int j,const int /*t*/) {
+				ov->drawPolygon( (j<intpcount) ? intp[j] : extp[j-intpcount],j );
+			});
+			printf(".");
+			parallelIndex(anzp,[&](const int j,const int /*t*/) {
+				if (j > ersterfehler) return;
+				if ( (cache) && (cache->has(QCCACHE_REGION,keyb[j]) > 0) ) return;
+				int ok;
+				if (j < intpcount) ok=qcBRegion(inbild,intp[j],COLORBLACK,ov,j,sammler);
+				else ok=qcBRegion(inbild,extp[j-intpcount],COLORWHITE,ov,j,sammler);
+				if ( (ok <= 0) && (!sammler) ) atomicMinI(ersterfehler,j);
+			});
+			delete ov;
+		}
+		printf(".");
+
+		for(int j=0;j<ersterfehler;j++) {
+			if (j < intpcount) qcBDraw(inbild,intp[j],INTPOLCOL);
+			else qcBDraw(inbild,extp[j-intpcount],EXTPOLCOL);
+		}
+		if (ersterfehler < anzp) {
+			int j=ersterfehler;
+			if (j < intpcount) qcB(inbild,intp[j],COLORBLACK,INTPOLCOL);
+			else qcB(inbild,extp[j-intpcount],COLORWHITE,EXTPOLCOL);
+			printf(" !! FAILED !!\n");
+			return 0;
+		}
+
+		// now all polygons are drawn in their color
+		// and they don't cross each other or touch
+		// the boundary
+		// do they touch one another ?
+	
+	
+		printf(".");
+		// go over all polygons again and follow their
+		// edges. Check whether there are the right
+		// count of polygon colored pixels and free ones
+		// so that polygons do not touch each other
+		// read-only, so in parallel; the first failing polygon
+		// is checked again to report
+		std::atomic<int> ersterfehler2(anzp);
+		if ( (qcmerged) && (qcmerged->touch >= 0) ) ersterfehler2=qcmerged->touch;
+		parallelIndex( (qcmerged) ? 0 : anzp,[&](const int j,const int /*t*/) {
+			if (j > ersterfehler2) return;
+			int ok;
+			if (j < intpcount) ok=qcB2(inbild,intp[j],COLORBLACK,INTPOLCOL,0,sammler,j);
+			else ok=qcB2(inbild,extp[j-intpcount],COLORWHITE,EXTPOLCOL,0,sammler,j);
+			if ( (ok <= 0) && (!sammler) ) atomicMinI(ersterfehler2,j);
+		});
+		if (ersterfehler2 < anzp) {
+			int j=ersterfehler2;
+			if (j < intpcount) qcB2(inbild,intp[j],COLORBLACK,INTPOLCOL,1);
+			else qcB2(inbild,extp[j-intpcount],COLORWHITE,EXTPOLCOL,1);
+			LOGMSG("FAILED.");
+			return 0;
+		}
+
+		if ( (sammler) && (sammler->anzahl > 0) ) {
+			LOGMSG2("\n  FAILED (collected, %i findings so far)\n",(int)sammler->anzahl);
+		} else {
+			LOGMSG("\n  PASSED\n");
+		}
+	}
+	if (cp) cp->advance(QCPHASE_ORACLE);
+	if (cache) {
+		if (startphase <= QCPHASE_BITMAP) {
+			for(int j=0;j<anzp;j++) cache->add(QCCACHE_REGION,keyb[j]);
+			cache->save(QCCACHEFN);
+		}
+		keyc.resize(intpcount);
+		for(int j=0;j<intpcount;j++) {
+			int x0,y0,x1,y1;
+			qcPixelBox(intp[j],qcOracleMargin(intp[j]),x0,y0,x1,y1);
+			keyc[j]=qcImageHash(keya[j],inbild,x0,y0,x1,y1);
+		}
+	}
+
+	// C-Test
+	// bitmap-driven oracle test
+	// every non-white pixel must lie on the exterior
+	// of at least ONE exterior polygon
+	// every non-black pixel must lie outside ALL
+	// interior polygons
+	
+	LOGMSG("QC oracle check: where do pixels lie with respect to polygon ");
+
+	// QCCACHE: unchanged interior polygons keep their verdict,
+	// the changed ones are tested in their boxes only
+	int otest=1;
+	if (cache) otest=qcCacheOracleMode(*cache,keyc,keyx);
+	if (qcmerged) {
+		if (qcmerged->oracleart >= 0) {
+			qcOracleError(qcmerged->oracleart,qcmerged->oraclex,qcmerged->oracley);
+			return 0;
+		}
+		LOGMSG("(rows checked by the shards) ");
+	} else if (otest == 1) {
+		if (qcOracleTest(cp,sammler) <= 0) return 0;
+	} else if (otest == 2) {
+		if (qcOracleBoxes(*cache,keyc) <= 0) return 0;
+	} else {
+		LOGMSG("(all polygons unchanged, verdict from the cache) ");
+	}
+	if (cache) {
+		for(int j=0;j<intpcount;j++) cache->add(QCCACHE_ORACLE,keyc[j]);
+		cache->add(QCCACHE_EXTERIOR,keyx);
+		cache->save(QCCACHEFN);
+	}
+
+	unPrepareYOracle();
+	if ( (sammler) && (sammler->anzahl > 0) ) {
+		LOGMSG("\n  FAILED (collected)\n");
+		qcReportWrite(*sammler);
+		return 0;
+	}
+	if (cp) cp->advance(QCPHASE_SMALL);
+	LOGMSG("\n  PASSED\n");
+	LOGMSG("    i.e. no non-white pixel is judged as exterior\n");
+	LOGMSG("    and  no non-black pixel is judged as interior\n");
+	
+	inbild.saveAsBmp("_FINAL_all_polygons.bmp");
+
+	printf("\n\nadding to small image ...");
+	double px,py;
+	for(int y=0;y<SMALLLEN;y++) {
+		py=(y+0.23)*smallskala + sm0;
+		
+		prepareYOracle(py);
+		
+		for(int x=0;x<SMALLLEN;x++) {
+			if (small.getPoint(x,y) != COLORGRAY) continue;
+			px=(x+0.23)*smallskala + sm0;
+			int erg=jsoracle(px,py);
+			
+			switch (erg) {
+				case PIP_EXTERIOR: small.setPoint(x,y,COLORWHITE); break;
+				case PIP_INTERIOR: small.setPoint(x,y,COLORBLACK); break;
+				case PIP_UNKNOWN: small.setPoint(x,y,COLORGRAY); break;
+				default: LOGMSG("\n\nERROR. Small. jsOracle.\n"); return 0;
+			}
+		}
+	}
+	unPrepareYOracle();
+
+	delete[] intp;
+	delete[] extp;
+	
+	if (allvalid>0) {
+		LOGMSG3("\n=========================================================\n\nVALID: Quality control: all consecutively numbered %i interior and %i exterior polygons passed the tests.\n\n=========================================================\n",intpcount,extpcount);
+		small.saveAsBmp("_QC_passed_small_result.bmp");
+		return 1;
+	} else {
+		LOGMSG("\nFAILURE: Quality control: set of polygons NOT USABLE.\n");
+		return 0;
+	}
+	
+	return allvalid;
+}
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+//
+// exact area judged interior / exterior by the
+// polygons, as a figure of merit of a polygon set
+//
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+VLONG scanStencilCount(
+	std::vector<ScanPolygon*>& asp,const int aklasse,
+	const VLONG ax0,const VLONG ax1,const int ay0,const int ay1
+) {
+	// number of grid points in [ax0,ax1]x[ay0,ay1] whose 5x5
+	// stencil is aklasse for every polygon in asp, i.e. the
+	// stencil centres the oracle judges that way. A grid row
+	// is the same on every vertex level and on every row of
+	// the open band between two levels, so per polygon each
+	// level and each band is classified once (rows in
+	// increasing order, the sweep goes on). A stencil row whose
+	// five rows lie in one band is the same for the whole band,
+	// only the stencils touching a level are intersected one
+	// by one. Work depends on the vertices, not on the rows
+	int anz=(int)asp.size();
+	std::vector<int> level;
+	for(int p=0;p<anz;p++) {
+		Polygon* pg=asp[p]->pg;
+		for(int i=0;i<pg->pointcount;i++) level.push_back(pg->points[i].y);
+	}
+	std::sort(level.begin(),level.end());
+	level.erase(std::unique(level.begin(),level.end()),level.end());
+	int L=(int)level.size();
+
+	// type 2k: band below level k (2L: above the last),
+	// type 2k+1: level k. Intervals shrunk by the stencil
+	// half-width, per polygon and type
+	auto typ=[&](const int y) {
+		int k=(int)(std::lower_bound(level.begin(),level.end(),y)-level.begin());
+		if ( (k < L) && (level[k] == y) ) return 2*k+1;
+		return 2*k;
+	};
+	std::vector<std::vector<VLONG> > zeilen((VLONG)anz*(2*L+1));
+	std::vector<VLONG> iv;
+	for(int p=0;p<anz;p++) {
+		ScanSweep sw;
+		for(int t=0;t<=2*L;t++) {
+			int y;
+			if ( (t & 1) != 0) y=level[t >> 1];
+			else if (L <= 0) y=0;
+			else if (t == 0) y=level[0]-1;
+			else {
+				y=level[(t >> 1)-1]+1;
+				// empty band between adjacent levels
+				if ( ((t >> 1) < L) && (y >= level[t >> 1]) ) continue;
+			}
+			asp[p]->row(sw,y,aklasse,iv);
+			std::vector<VLONG>& z=zeilen[(VLONG)p*(2*L+1)+t];
+			for(int m=0;m<(int)iv.size();m+=2) {
+				if ( (iv[m]+2) <= (iv[m+1]-2) ) {
+					z.push_back(iv[m]+2);
+					z.push_back(iv[m+1]-2);
+				}
+			}
+		}
+	}
+
+	VLONG summe=0;
+	std::vector<VLONG> schnitt,neu;
+	for(int cy=ay0;cy<=ay1;) {
+		int t0=typ(cy-2),t4=typ(cy+2);
+		int lauf=1;
+		if ( (t0 == t4) && ( (t0 & 1) == 0) ) {
+			// all five rows in one band: up to the stencil
+			// that reaches the next level
+			int k=t0 >> 1;
+			int ende=( (k < L) ? level[k]-3 : ay1 );
+			lauf=minimumI(ende,ay1)-cy+1;
+		}
+		schnitt.clear();
+		schnitt.push_back(ax0);
+		schnitt.push_back(ax1);
+		for(int p=0;( (p < anz) && (schnitt.size() > 0) );p++) {
+			for(int dy=-2;( (dy <= 2) && (schnitt.size() > 0) );dy++) {
+				std::vector<VLONG>& z=zeilen[(VLONG)p*(2*L+1)+typ(cy+dy)];
+				neu.clear();
+				int a=0,b=0;
+				while ( (a < (int)schnitt.size()) && (b < (int)z.size()) ) {
+					VLONG lo=( (schnitt[a] > z[b]) ? schnitt[a] : z[b] );
+					VLONG hi=( (schnitt[a+1] < z[b+1]) ? schnitt[a+1] : z[b+1] );
+					if (lo <= hi) {
+						neu.push_back(lo);
+						neu.push_back(hi);
+					}
+					if (schnitt[a+1] < z[b+1]) a+=2; else b+=2;
+				}
+				schnitt.swap(neu);
+			}
+		}
+		VLONG n=0;
+		for(int m=0;m<(int)schnitt.size();m+=2) n += schnitt[m+1]-schnitt[m]+1;
+		summe += n*lauf;
+		cy += lauf;
+	}
+
+	return summe;
+}
+
+int polygonArea(void) {
+	// exact area the oracle judges interior (union of the
+	// interior polygons' stencil centres, disjoint for a set
+	// that passed QC) and exterior (stencil outside every
+	// exterior polygon, within the RANGE square), compared
+	// with the black and white pixels of _in.bmp. A grid
+	// point stands for the 1/nenner square to its upper
+	// right, as the oracle floors the coordinates. Symmetric
+	// sets: the stored half, y >= 0, against that half of
+	// the image
+	loadAllPolygons();
+	if ( (intpcount<=0) && (extpcount<=0) ) {
+		LOGMSG("\n\nERROR. No polygons loaded.\n");
+		return 0;
+	}
+
+	int pyi0=0;
+	if (symmetry != SYM_NONE) pyi0=inbild.ylen >> 1;
+	VLONG schwarz=0,weiss=0;
+	for(int y=pyi0;y<inbild.ylen;y++) {
+		for(int x=0;x<inbild.xlen;x++) {
+			BYTE f=inbild.getPoint(x,y);
+			if (f == COLORBLACK) schwarz++;
+			else if (f == COLORWHITE) weiss++;
+		}
+	}
+	double pixflaeche=skalaRangeProPixel*skalaRangeProPixel;
+	double y0=( (symmetry != SYM_NONE) ? 0.0 : (double)RANGE0 );
+
+	char tmp[1024];
+	sprintf(tmp,"image: %lld black, %lld white pixels%s\n",(long long)schwarz,(long long)weiss,
+		(symmetry != SYM_NONE) ? " (stored half)" : "");
+	LOGMSG2("%s",tmp);
+
+	// per interior polygon its own grid
+	double intflaeche=0.0;
+	for(int i=0;i<intpcount;i++) {
+		ScanPolygon sp;
+		sp.init(&intp[i]);
+		std::vector<ScanPolygon*> v(1,&sp);
+		VLONG n=intp[i].nenner;
+		VLONG anz=scanStencilCount(v,PIP_INTERIOR,(VLONG)RANGE0*n,(VLONG)RANGE1*n-1,(int)floor(y0*n),(int)(RANGE1*n-1));
+		double pix=(double)anz / ((double)n*n) / pixflaeche;
+		intflaeche += pix;
+		sprintf(tmp,"interior %4i: %14.2f pixels, %8.4f%% of black\n",i,pix,
+			(schwarz > 0) ? 100.0*pix/schwarz : 0.0);
+		LOGMSG2("%s",tmp);
+	}
+
+	// exterior: per polygon, and all of them at once,
+	// which needs one common grid
+	std::vector<ScanPolygon> extsp(extpcount);
+	std::vector<ScanPolygon*> alle;
+	VLONG nennerext=0;
+	int gemeinsam=1;
+	for(int i=0;i<extpcount;i++) {
+		if (extp[i].pointcount <= 0) continue;
+		extsp[i].init(&extp[i]);
+		alle.push_back(&extsp[i]);
+		VLONG n=extp[i].nenner;
+		if (nennerext == 0) nennerext=n;
+		else if (n != nennerext) gemeinsam=0;
+		std::vector<ScanPolygon*> v(1,&extsp[i]);
+		VLONG anz=scanStencilCount(v,PIP_EXTERIOR,(VLONG)RANGE0*n,(VLONG)RANGE1*n-1,(int)floor(y0*n),(int)(RANGE1*n-1));
+		double pix=(double)anz / ((double)n*n) / pixflaeche;
+		sprintf(tmp,"exterior %4i: %14.2f pixels outside, %8.4f%% of white\n",i,pix,
+			(weiss > 0) ? 100.0*pix/weiss : 0.0);
+		LOGMSG2("%s",tmp);
+	}
+	double extflaeche=0.0;
+	if ( (alle.size() > 0) && (gemeinsam > 0) ) {
+		VLONG n=nennerext;
+		VLONG anz=scanStencilCount(alle,PIP_EXTERIOR,(VLONG)RANGE0*n,(VLONG)RANGE1*n-1,(int)floor(y0*n),(int)(RANGE1*n-1));
+		extflaeche=(double)anz / ((double)n*n) / pixflaeche;
+	}
+
+	sprintf(tmp,"\ninterior: %.2f pixels judged interior, %.4f%% of the black area\n",intflaeche,
+		(schwarz > 0) ? 100.0*intflaeche/schwarz : 0.0);
+	LOGMSG2("%s",tmp);
+	if (gemeinsam > 0) {
+		sprintf(tmp,"exterior: %.2f pixels judged exterior, %.4f%% of the white area\n",extflaeche,
+			(weiss > 0) ? 100.0*extflaeche/weiss : 0.0);
+		LOGMSG2("%s",tmp);
+	} else {
+		LOGMSG("exterior: polygons with different denominators, no total\n");
+	}
+
+	delete[] intp;
+	delete[] extp;
+	intp=extp=NULL;
+
+	return 1;
+}
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+//
+// multi-resolution tile pyramid of oracle results
+// for zoomable viewers
+//
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+inline BYTE get2bit(BYTE* feld,const VLONG side,const VLONG x,const VLONG y) {
+	VLONG pos=y*side+x;
+	return (feld[pos >> 2] >> ((pos & 3) << 1)) & 0b11;
+}
+
+inline void set2bit(BYTE* feld,const VLONG side,const VLONG x,const VLONG y,const BYTE f) {
+	VLONG pos=y*side+x;
+	feld[pos >> 2] |= (f << ((pos & 3) << 1));
+}
+
+int tilePyramid(void) {
+	// level l consists of 2^l x 2^l tiles of TILESIZE^2 pixels
+	// covering RANGE x RANGE. A pixel is judged by the oracle
+	// at its lower left corner and stored as 2 bit class
+	// (COLORGRAY=unknown, COLORWHITE=exterior, COLORBLACK=interior).
+	// Only the finest level is computed by the oracle, as the
+	// corner of a coarse pixel IS the corner of a fine pixel,
+	// coarser levels take every second fine pixel - exact,
+	// not an approximation.
+	
+	// file _oracle_tiles.pyr:
+	//	"JPTP", int version, tilesize, levels, RANGE0, RANGE1, reserved
+	//	directory: per level, per tile row (from bottom), per tile: VLONG
+	//		>= 0: file offset of the tile's pixels (TILESIZE^2/4 bytes,
+	//			rows from bottom, 4 pixels per byte, first pixel in lowest bits)
+	//		< 0: tile consists entirely of class (-entry-1), no pixel data
+	//	tile pixel data
+	
+	if ( (TILESIZE < 4) || ( (TILESIZE & (TILESIZE-1)) != 0) ) {
+		LOGMSG("\nERROR. TILESIZE must be a power of 2 and at least 4.\n");
+		return 0;
+	}
+	if ( (TILELEVELS < 1) || (TILELEVELS > 16) || ( ((VLONG)TILESIZE << (TILELEVELS-1)) > 65536) ) {
+		LOGMSG("\nERROR. TILELEVELS out of range. Finest level can be at most 65536 pixels wide.\n");
+		return 0;
+	}
+	
+	loadAllPolygons();
+	if ( (intpcount<=0) && (extpcount<=0) ) {
+		LOGMSG("\n\nERROR. No polygons loaded.\n");
+		return 0;
+	}
+	unPrepareYOracle();
+	
+	int L=TILELEVELS;
+	VLONG side[16];
+	BYTE* level[16];
+	for(int l=0;l<L;l++) {
+		side[l]=(VLONG)TILESIZE << l;
+		VLONG bytes=(side[l]*side[l]) >> 2;
+		level[l]=new BYTE[bytes];
+		if (!level[l]) {
+			LOGMSG("\nMemory error tile pyramid.\n");
+			exit(99);
+		}
+		memset(level[l],0,bytes);
+	}
+	
+	// finest level: rows distributed over the threads,
+	// each with its own row preparation
+	int fl=L-1;
+	VLONG S=side[fl];
+	double skala=(double)(RANGE1-RANGE0) / S;
+	int tc=getThreadCount();
+	printf("computing finest level %i with %i threads ",fl,tc);
+	
+	RowPrepare** rps=new RowPrepare*[tc];
+	for(int t=0;t<tc;t++) rps[t]=new RowPrepare;
+	std::atomic<int> rowsdone(0);
+	int noch0=maximumI(1,(int)(S >> 4));
+	
+	parallelIndex((int)S,[&](const int y,const int t) {
+		double py=y*skala + RANGE0;
+		rps[t]->prepare(py);
+		for(VLONG x=0;x<S;x++) {
+			double px=x*skala + RANGE0;
+			BYTE f;
+			switch (jsoracle(px,py,rps[t])) {
+				case PIP_INTERIOR: f=COLORBLACK; break;
+				case PIP_EXTERIOR: f=COLORWHITE; break;
+				default: f=COLORGRAY; break;
+			}
+			// rows are multiples of 4 pixels, so threads
+			// never share a byte
+			set2bit(level[fl],S,x,y,f);
+		}
+		if ( ((++rowsdone) % noch0) == 0) printf(".");
+	});
+	
+	for(int t=0;t<tc;t++) delete rps[t];
+	delete[] rps;
+	
+	// coarser levels by exact subsampling
+	for(int l=fl-1;l>=0;l--) {
+		for(VLONG y=0;y<side[l];y++) {
+			for(VLONG x=0;x<side[l];x++) {
+				set2bit(level[l],side[l],x,y,get2bit(level[l+1],side[l+1],x << 1,y << 1));
+			}
+		}
+	}
+	
+	// directory
+	VLONG tilebytes=((VLONG)TILESIZE*TILESIZE) >> 2;
+	VLONG rowbytes=TILESIZE >> 2;
+	VLONG entries=0;
+	for(int l=0;l<L;l++) entries += ((VLONG)1 << l)*((VLONG)1 << l);
+	VLONG* dir=new VLONG[entries];
+	int HEADERLEN=32;
+	VLONG offset=HEADERLEN + entries*sizeof(VLONG);
+	VLONG e=0;
+	
+	printf("\n");
+	for(int l=0;l<L;l++) {
+		int anz=1 << l;
+		int konstant=0;
+		for(int ty=0;ty<anz;ty++) {
+			for(int tx=0;tx<anz;tx++) {
+				// constant if every byte equals the pattern of the first pixel
+				BYTE f=get2bit(level[l],side[l],(VLONG)tx*TILESIZE,(VLONG)ty*TILESIZE);
+				BYTE muster=f*0b01010101;
+				int gleich=1;
+				for(int r=0;((gleich>0)&&(r<TILESIZE));r++) {
+					BYTE* zeile=&level[l][( ((VLONG)ty*TILESIZE+r)*side[l] + (VLONG)tx*TILESIZE ) >> 2];
+					for(VLONG b=0;b<rowbytes;b++) {
+						if (zeile[b] != muster) {
+							gleich=0;
+							break;
+						}
+					}
+				}
+				
+				if (gleich>0) {
+					dir[e]=-1-(VLONG)f;
+					konstant++;
+				} else {
+					dir[e]=offset;
+					offset += tilebytes;
+				}
+				e++;
+			}
+		}
+		LOGMSG3("level %i: %i tiles, ",l,anz*anz);
+		LOGMSG2("%i constant\n",konstant);
+	}
+	
+	FILE *f=fopen("_oracle_tiles.pyr","wb");
+	if (!f) {
+		LOGMSG("\nERROR. Cannot write _oracle_tiles.pyr.\n");
+		return 0;
+	}
+	
+	int header[8];
+	memcpy(&header[0],"JPTP",4);
+	header[1]=1;
+	header[2]=TILESIZE;
+	header[3]=L;
+	header[4]=RANGE0;
+	header[5]=RANGE1;
+	header[6]=header[7]=0;
+	fwrite(header,sizeof(int),8,f);
+	fwrite(dir,sizeof(VLONG),entries,f);
+	
+	e=0;
+	for(int l=0;l<L;l++) {
+		int anz=1 << l;
+		for(int ty=0;ty<anz;ty++) {
+			for(int tx=0;tx<anz;tx++) {
+				if (dir[e++] >= 0) {
+					for(int r=0;r<TILESIZE;r++) {
+						fwrite(&level[l][( ((VLONG)ty*TILESIZE+r)*side[l] + (VLONG)tx*TILESIZE ) >> 2],1,rowbytes,f);
+					}
+				}
+			}
+		}
+	}
+	
+	fclose(f);
+	LOGMSG2("tile pyramid with %i levels written to _oracle_tiles.pyr\n",L);
+	
+	delete[] dir;
+	for(int l=0;l<L;l++) delete[] level[l];
+	delete[] intp;
+	delete[] extp;
+	intp=extp=NULL;
+	
+	return 1;
+}
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+//
+// code generator: bakes the loaded polygons into a
+// C++ header with a compile-time oracle
+//
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+void writeIntArray(FILE* f,const char* aname,const int* a,const VLONG anz) {
+	// zero-length arrays are not allowed, so at least one entry
+	fprintf(f,"constexpr int %s[]={",aname);
+	if (anz <= 0) fprintf(f,"0");
+	for(VLONG i=0;i<anz;i++) {
+		if ( (i % 16) == 0) fprintf(f,"\n\t");
+		fprintf(f,"%i",a[i]);
+		if (i < (anz-1)) fprintf(f,",");
+	}
+	fprintf(f,"\n};\n");
+}
+
+VLONG writeSlabPolygon(FILE* f,Polygon& apg,const char* aname) {
+	// decision structure of one polygon:
+	// levely: sorted distinct vertex y coordinates
+	// slab k is the open band levely[k] < y < levely[k+1], the vertical
+	// edges crossing it are constant, their sorted x coordinates are
+	// slabx[slabstart[k]..slabstart[k+1]-1]
+	// horizontal edges at levely[k] are the sorted intervals
+	// hx[2*j],hx[2*j+1] for j=hstart[k]..hstart[k+1]-1
+	// returns number of stored slab entries
+	
+	std::vector<int> levely;
+	for(int i=0;i<apg.pointcount;i++) levely.push_back(apg.points[i].y);
+	std::sort(levely.begin(),levely.end());
+	levely.erase(std::unique(levely.begin(),levely.end()),levely.end());
+	int m=(int)levely.size();
+	
+	#define LEVELINDEX(YY) \
+		(int)(std::lower_bound(levely.begin(),levely.end(),(YY))-levely.begin())
+	
+	std::vector< std::vector<int> > slab(m);
+	std::vector< std::vector< std::pair<int,int> > > hor(m);
+	
+	for(int i=1;i<apg.pointcount;i++) {
+		if (apg.points[i].x == apg.points[i-1].x) {
+			int a=LEVELINDEX(minimumI(apg.points[i].y,apg.points[i-1].y));
+			int b=LEVELINDEX(maximumI(apg.points[i].y,apg.points[i-1].y));
+			for(int k=a;k<b;k++) slab[k].push_back(apg.points[i].x);
+		} else {
+			int k=LEVELINDEX(apg.points[i].y);
+			hor[k].push_back(std::pair<int,int>(
+				minimumI(apg.points[i].x,apg.points[i-1].x),
+				maximumI(apg.points[i].x,apg.points[i-1].x)
+			));
+		}
+	}
+	
+	std::vector<int> slabstart,slabx,hstart,hx;
+	for(int k=0;k<m;k++) {
+		std::sort(slab[k].begin(),slab[k].end());
+		std::sort(hor[k].begin(),hor[k].end());
+		slabstart.push_back((int)slabx.size());
+		slabx.insert(slabx.end(),slab[k].begin(),slab[k].end());
+		hstart.push_back((int)hx.size() >> 1);
+		for(unsigned int j=0;j<hor[k].size();j++) {
+			hx.push_back(hor[k][j].first);
+			hx.push_back(hor[k][j].second);
+		}
+	}
+	slabstart.push_back((int)slabx.size());
+	hstart.push_back((int)hx.size() >> 1);
+	
+	char tmp[2048];
+	sprintf(tmp,"%s_points",aname);
+	writeIntArray(f,tmp,(int*)apg.points,2*(VLONG)apg.pointcount);
+	sprintf(tmp,"%s_levely",aname);
+	writeIntArray(f,tmp,levely.data(),m);
+	sprintf(tmp,"%s_slabstart",aname);
+	writeIntArray(f,tmp,slabstart.data(),slabstart.size());
+	sprintf(tmp,"%s_slabx",aname);
+	writeIntArray(f,tmp,slabx.data(),slabx.size());
+	sprintf(tmp,"%s_hstart",aname);
+	writeIntArray(f,tmp,hstart.data(),hstart.size());
+	sprintf(tmp,"%s_hx",aname);
+	writeIntArray(f,tmp,hx.data(),hx.size());
+	fprintf(f,"\n");
+	
+	return (VLONG)slabx.size();
+}
+
+void writePolygonEntry(FILE* f,Polygon& apg,const char* aname) {
+	int m=0;
+	// number of levels recomputed the same way as in writeSlabPolygon
+	std::vector<int> levely;
+	for(int i=0;i<apg.pointcount;i++) levely.push_back(apg.points[i].y);
+	std::sort(levely.begin(),levely.end());
+	m=(int)(std::unique(levely.begin(),levely.end())-levely.begin());
+	
+	fprintf(f,"\t{ %lld,%i,%i,%i,%i,%i,%i,%s_points,%s_levely,%s_slabstart,%s_slabx,%s_hstart,%s_hx },\n",
+		(long long)apg.nenner,apg.xmin,apg.xmax,apg.ymin,apg.ymax,
+		apg.pointcount,m,
+		aname,aname,aname,aname,aname,aname
+	);
+}
+
+int generateHeader(void) {
+	loadAllPolygons();
+	if ( (intpcount<=0) && (extpcount<=0) ) {
+		LOGMSG("\n\nERROR. No polygons loaded.\n");
+		return 0;
+	}
+	
+	char fn[2048];
+	sprintf(fn,"%s.h",genname);
+	FILE *f=fopen(fn,"wt");
+	if (!f) {
+		LOGMSG2("\nERROR. Cannot write %s.\n",fn);
+		return 0;
+	}
+	
+	fprintf(f,"// generated by polygon.exe cmd=GENHEADER - do not edit\n");
+	fprintf(f,"// %i interior and %i exterior polygons, range %i..%i\n",intpcount,extpcount,RANGE0,RANGE1);
+	fprintf(f,"//\n");
+	fprintf(f,"// %s::jsoracle(x,y) returns %s::INTERIOR, EXTERIOR or UNKNOWN with the\n",genname,genname);
+	fprintf(f,"// same 5x5 stencil semantics and results as polygon.exe cmd=ORACLE\n");
+	fprintf(f,"// on the polygons it was generated from. Needs C++11.\n\n");
+	fprintf(f,"#ifndef %s_H\n#define %s_H\n\n#include <math.h>\n\n",genname,genname);
+	fprintf(f,"namespace %s {\n\n",genname);
+	fprintf(f,"enum { UNKNOWN=0, INTERIOR, BOUNDARY, EXTERIOR };\n\n");
+	fprintf(f,"struct PolygonVH {\n");
+	fprintf(f,"\tlong long nenner;\n");
+	fprintf(f,"\tint xmin,xmax,ymin,ymax;\n");
+	fprintf(f,"\tint pointcount,levelcount;\n");
+	fprintf(f,"\tconst int *points;\n");
+	fprintf(f,"\t// sorted distinct vertex y coordinates\n");
+	fprintf(f,"\tconst int *levely;\n");
+	fprintf(f,"\t// band levely[k] < y < levely[k+1]: sorted x of the vertical\n");
+	fprintf(f,"\t// edges crossing it are slabx[slabstart[k]..slabstart[k+1]-1]\n");
+	fprintf(f,"\tconst int *slabstart,*slabx;\n");
+	fprintf(f,"\t// horizontal edges on levely[k]: sorted intervals\n");
+	fprintf(f,"\t// hx[2j],hx[2j+1] for j=hstart[k]..hstart[k+1]-1\n");
+	fprintf(f,"\tconst int *hstart,*hx;\n");
+	fprintf(f,"};\n\n");
+	
+	char tmp[2048];
+	VLONG slabsum=0;
+	for(int i=0;i<intpcount;i++) {
+		sprintf(tmp,"int%04i",i);
+		slabsum += writeSlabPolygon(f,intp[i],tmp);
+	}
+	for(int i=0;i<extpcount;i++) {
+		sprintf(tmp,"ext%04i",i);
+		slabsum += writeSlabPolygon(f,extp[i],tmp);
+	}
+	
+	// polygon tables, with a dummy entry if empty
+	fprintf(f,"// 1: point symmetric, 2: conjugate symmetric, only the upper half\n");
+	fprintf(f,"// plane is stored and lower half queries are mirrored\n");
+	fprintf(f,"constexpr int SYMMETRY=%i;\n",symmetry);
+	fprintf(f,"constexpr int INTPCOUNT=%i;\n",intpcount);
+	fprintf(f,"constexpr int EXTPCOUNT=%i;\n\n",extpcount);
+	fprintf(f,"constexpr PolygonVH intpolygons[]={\n");
+	for(int i=0;i<intpcount;i++) {
+		sprintf(tmp,"int%04i",i);
+		writePolygonEntry(f,intp[i],tmp);
+	}
+	if (intpcount<=0) fprintf(f,"\t{ 1,0,0,0,0,0,0,0,0,0,0,0,0 }\n");
+	fprintf(f,"};\n\n");
+	fprintf(f,"constexpr PolygonVH extpolygons[]={\n");
+	for(int i=0;i<extpcount;i++) {
+		sprintf(tmp,"ext%04i",i);
+		writePolygonEntry(f,extp[i],tmp);
+	}
+	if (extpcount<=0) fprintf(f,"\t{ 1,0,0,0,0,0,0,0,0,0,0,0,0 }\n");
+	fprintf(f,"};\n\n");
+	
+	// decision functions
+	fprintf(f,
+		"inline int point_in_polygonVH(const PolygonVH& p,const int x,const int y) {\n"
+		"\tif ( (x < p.xmin) || (x > p.xmax) || (y < p.ymin) || (y > p.ymax) ) return EXTERIOR;\n"
+		"\tif ( (y < p.levely[0]) || (y > p.levely[p.levelcount-1]) ) return EXTERIOR;\n"
+		"\n"
+		"\t// level k: last one with levely[k] <= y\n"
+		"\tint lo=0,hi=p.levelcount-1;\n"
+		"\twhile (lo < hi) {\n"
+		"\t\tint mid=(lo+hi+1) >> 1;\n"
+		"\t\tif (p.levely[mid] <= y) lo=mid; else hi=mid-1;\n"
+		"\t}\n"
+		"\tint k=lo;\n"
+		"\n"
+		"\tif (p.levely[k] == y) {\n"
+		"\t\t// on a horizontal edge ?\n"
+		"\t\tint a=p.hstart[k],b=p.hstart[k+1]-1;\n"
+		"\t\twhile (a < b) {\n"
+		"\t\t\tint mid=(a+b+1) >> 1;\n"
+		"\t\t\tif (p.hx[2*mid] <= x) a=mid; else b=mid-1;\n"
+		"\t\t}\n"
+		"\t\tif ( (a <= b) && (p.hx[2*a] <= x) && (x <= p.hx[2*a+1]) ) return BOUNDARY;\n"
+		"\t\t// a point off the boundary lies in the same region as\n"
+		"\t\t// the band directly above it\n"
+		"\t\tif (k == (p.levelcount-1)) return EXTERIOR;\n"
+		"\t}\n"
+		"\n"
+		"\t// even-odd count of crossings to the right in band k\n"
+		"\tconst int* s=&p.slabx[p.slabstart[k]];\n"
+		"\tint n=p.slabstart[k+1]-p.slabstart[k];\n"
+		"\tint a=0,b=n;\n"
+		"\twhile (a < b) {\n"
+		"\t\tint mid=(a+b) >> 1;\n"
+		"\t\tif (s[mid] < x) a=mid+1; else b=mid;\n"
+		"\t}\n"
+		"\tif ( (a < n) && (s[a] == x) ) return BOUNDARY;\n"
+		"\n"
+		"\treturn ( ((n-a) & 1) != 0) ? INTERIOR : EXTERIOR;\n"
+		"}\n\n"
+		"inline int jsoracle(double ax,double ay) {\n"
+		"\tconst int mxy=2;\n"
+		"\tconst int AREA=(mxy+mxy+1)*(mxy+mxy+1);\n"
+		"\n"
+		"\tif ( (SYMMETRY != 0) && (ay < 0.0) ) {\n"
+		"\t\tif (SYMMETRY == 1) ax=-ax;\n"
+		"\t\tay=-ay;\n"
+		"\t}\n"
+		"\n"
+		"\tfor(int i=0;i<INTPCOUNT;i++) {\n"
+		"\t\tint px=(int)floor(ax*intpolygons[i].nenner);\n"
+		"\t\tint py=(int)floor(ay*intpolygons[i].nenner);\n"
+		"\t\tint ic=0;\n"
+		"\t\tfor(int dy=-mxy;((ic>=0)&&(dy<=mxy));dy++) {\n"
+		"\t\t\tfor(int dx=-mxy;((ic>=0)&&(dx<=mxy));dx++) {\n"
+		"\t\t\t\tif (point_in_polygonVH(intpolygons[i],px+dx,py+dy) == INTERIOR) ic++;\n"
+		"\t\t\t\telse ic=-1;\n"
+		"\t\t\t}\n"
+		"\t\t}\n"
+		"\t\tif (ic == AREA) return INTERIOR;\n"
+		"\t}\n"
+		"\n"
+		"\tfor(int i=0;i<EXTPCOUNT;i++) {\n"
+		"\t\tint px=(int)floor(ax*extpolygons[i].nenner);\n"
+		"\t\tint py=(int)floor(ay*extpolygons[i].nenner);\n"
+		"\t\tint ic=0;\n"
+		"\t\tfor(int dy=-mxy;((ic>=0)&&(dy<=mxy));dy++) {\n"
+		"\t\t\tfor(int dx=-mxy;((ic>=0)&&(dx<=mxy));dx++) {\n"
+		"\t\t\t\tif (point_in_polygonVH(extpolygons[i],px+dx,py+dy) == EXTERIOR) ic++;\n"
+		"\t\t\t\telse ic=-1;\n"
+		"\t\t\t}\n"
+		"\t\t}\n"
+		"\t\tif (ic != AREA) return UNKNOWN;\n"
+		"\t}\n"
+		"\n"
+		"\tif (EXTPCOUNT > 0) return EXTERIOR;\n"
+		"\n"
+		"\treturn UNKNOWN;\n"
+		"}\n\n"
+	);
+	
+	fprintf(f,"} // namespace %s\n\n#endif\n",genname);
+	fclose(f);
+	
+	LOGMSG3("header %s written: %i interior, ",fn,intpcount);
+	LOGMSG2("%i exterior polygons, ",extpcount);
+	LOGMSG2("%lld slab entries\n",(long long)slabsum);
+	
+	delete[] intp;
+	delete[] extp;
+	intp=extp=NULL;
+	
+	return 1;
+}
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+//
+// benchmark: oracle throughput and latency on the
+// loaded polygon set for deterministic workloads
+//
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+inline unsigned long long benchRandom(unsigned long long& astate) {
+	// splitmix64, same sequence on every platform
+	unsigned long long z=(astate += 0x9E3779B97F4A7C15ULL);
+	z=(z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z=(z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+inline double benchUniform(unsigned long long& astate) {
+	// in [0,1)
+	return (benchRandom(astate) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+int benchWorkload(const int atyp,const int anz,double* ax,double* ay) {
+	// fills ax,ay with anz complex numbers of workload atyp,
+	// returns the number generated (can be less if the
+	// polygon set does not allow enough of that kind)
+	unsigned long long state=0x4A554C4941ULL + atyp;
+	double breite=RANGE1-RANGE0;
+	int n=0;
+	
+	if (atyp == BENCH_UNIFORM) {
+		for(;n<anz;n++) {
+			ax[n]=RANGE0 + benchUniform(state)*breite;
+			ay[n]=RANGE0 + benchUniform(state)*breite;
+		}
+	} else
+	if (atyp == BENCH_NEAREDGE) {
+		// random edge (weighted by edge count), random point
+		// on it, moved up to 8 grid units in both directions
+		int anzp=intpcount+extpcount;
+		std::vector<VLONG> kum(anzp+1,0);
+		for(int i=0;i<anzp;i++) {
+			Polygon& pg=( (i<intpcount) ? intp[i] : extp[i-intpcount] );
+			pg.ensureLoaded();
+			kum[i+1]=kum[i] + maximumI(pg.pointcount-1,0);
+		}
+		if (kum[anzp] <= 0) return 0;
+		for(;n<anz;n++) {
+			VLONG k=(VLONG)(benchRandom(state) % (unsigned long long)kum[anzp]);
+			int i=(int)(std::upper_bound(kum.begin(),kum.end(),k)-kum.begin())-1;
+			Polygon& pg=( (i<intpcount) ? intp[i] : extp[i-intpcount] );
+			int e=(int)(k-kum[i]);
+			double t=benchUniform(state);
+			double gx=pg.points[e].x + t*(pg.points[e+1].x-pg.points[e].x);
+			double gy=pg.points[e].y + t*(pg.points[e+1].y-pg.points[e].y);
+			gx += benchUniform(state)*16.0 - 8.0;
+			gy += benchUniform(state)*16.0 - 8.0;
+			ax[n]=gx / pg.nenner;
+			ay[n]=gy / pg.nenner;
+		}
+	} else
+	if (atyp == BENCH_DEEPINT) {
+		// inside an interior polygon's 5x5 stencil and the
+		// polygon's interior a sixteenth of its size around it
+		if (intpcount <= 0) return 0;
+		VLONG versuche=(VLONG)anz*64;
+		while ( (n<anz) && ((--versuche) > 0) ) {
+			int i=(int)(benchRandom(state) % (unsigned long long)intpcount);
+			Polygon& pg=intp[i];
+			pg.ensureLoaded();
+			int gx=pg.xmin + (int)(benchUniform(state)*(pg.xmax-pg.xmin));
+			int gy=pg.ymin + (int)(benchUniform(state)*(pg.ymax-pg.ymin));
+			int d=maximumI(1,minimumI(pg.xmax-pg.xmin,pg.ymax-pg.ymin) >> 4);
+			int tief=1;
+			for(int dy=-d;((tief>0)&&(dy<=d));dy+=d) {
+				for(int dx=-d;((tief>0)&&(dx<=d));dx+=d) {
+					if (point_in_polygonVH(pg,gx+dx,gy+dy) != PIP_INTERIOR) tief=0;
+				}
+			}
+			if (tief <= 0) continue;
+			double x=(double)gx / pg.nenner;
+			double y=(double)gy / pg.nenner;
+			if (jsoracleWith(&pg,1,NULL,0,x,y) != PIP_INTERIOR) continue;
+			ax[n]=x;
+			ay[n]=y;
+			n++;
+		}
+	} else
+	if (atyp == BENCH_FAREXT) {
+		// within RANGE, but outside the bounding box of
+		// every polygon (after symmetry folding)
+		VLONG versuche=(VLONG)anz*64;
+		while ( (n<anz) && ((--versuche) > 0) ) {
+			double x=RANGE0 + benchUniform(state)*breite;
+			double y=RANGE0 + benchUniform(state)*breite;
+			double fx=x,fy=y;
+			foldSymmetry(symmetry,fx,fy);
+			int weit=1;
+			for(int i=0;((weit>0)&&(i<(intpcount+extpcount)));i++) {
+				Polygon& pg=( (i<intpcount) ? intp[i] : extp[i-intpcount] );
+				double gx=fx*pg.nenner;
+				double gy=fy*pg.nenner;
+				if (
+					(gx >= (pg.xmin-8)) && (gx <= (pg.xmax+8)) &&
+					(gy >= (pg.ymin-8)) && (gy <= (pg.ymax+8))
+				) weit=0;
+			}
+			if (weit <= 0) continue;
+			ax[n]=x;
+			ay[n]=y;
+			n++;
+		}
+	}
+	
+	return n;
+}
+
+int benchmark(void) {
+	loadAllPolygons(lazyload);
+	if ( (intpcount<=0) && (extpcount<=0) ) {
+		LOGMSG("\n\nERROR. No polygons loaded.\n");
+		return 0;
+	}
+	unPrepareYOracle();
+	
+	const char* name[]={ "uniform","near-edge","deep-interior","far-exterior" };
+	int N=BENCHCOUNT;
+	double* qx=new double[N];
+	double* qy=new double[N];
+	BYTE* verdict=new BYTE[N];
+	double* latenz=new double[N];
+	if ( (!qx) || (!qy) || (!verdict) || (!latenz) ) {
+		LOGMSG("\nMemory error benchmark.\n");
+		exit(99);
+	}
+	
+	// thread counts 1,2,4,... up to the maximum
+	int maxtc=getThreadCount();
+	int merkthreads=threadcount;
+	std::vector<int> tcs;
+	for(int t=1;t<maxtc;t <<= 1) tcs.push_back(t);
+	tcs.push_back(maxtc);
+	
+	LOGMSG3("benchmark: %i interior and %i exterior polygons, ",intpcount,extpcount);
+	LOGMSG2("%i queries per workload\n",N);
+	
+	// queries are handed out in blocks to keep the
+	// distribution overhead out of the measurement
+	const int BLOCK=256;
+	int blocks;
+	char tmp[1024];
+	
+	for(int w=0;w<BENCHWORKLOADS;w++) {
+		int n=benchWorkload(w,N,qx,qy);
+		if (n <= 0) {
+			LOGMSG2("\nworkload %s: no queries possible for this polygon set\n",name[w]);
+			continue;
+		}
+		blocks=(n+BLOCK-1) / BLOCK;
+		
+		// untimed pass: verdicts, and loads lazy polygons
+		threadcount=maxtc;
+		parallelIndex(blocks,[&](const int b,const int) {
+			int ende=minimumI(n,(b+1)*BLOCK);
+			for(int i=b*BLOCK;i<ende;i++) verdict[i]=(BYTE)jsoracle(qx[i],qy[i]);
+		});
+		
+		int anzerg[4]={0,0,0,0};
+		for(int i=0;i<n;i++) anzerg[verdict[i] & 3]++;
+		sprintf(tmp,"\nworkload %s (%i queries): interior %.1lf%%, exterior %.1lf%%, unknown %.1lf%%\n",
+			name[w],n,
+			100.0*anzerg[PIP_INTERIOR]/n,
+			100.0*anzerg[PIP_EXTERIOR]/n,
+			100.0*anzerg[PIP_UNKNOWN]/n
+		);
+		LOGMSG2("%s",tmp);
+		
+		for(unsigned int k=0;k<tcs.size();k++) {
+			threadcount=tcs[k];
+			auto start=std::chrono::steady_clock::now();
+			parallelIndex(blocks,[&](const int b,const int) {
+				int ende=minimumI(n,(b+1)*BLOCK);
+				for(int i=b*BLOCK;i<ende;i++) {
+					auto t0=std::chrono::steady_clock::now();
+					jsoracle(qx[i],qy[i]);
+					auto t1=std::chrono::steady_clock::now();
+					latenz[i]=std::chrono::duration<double,std::nano>(t1-t0).count();
+				}
+			});
+			double sek=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+			
+			std::sort(latenz,latenz+n);
+			sprintf(tmp,"  threads %3i: %12.0lf queries/s  latency p50 %.3lf us, p90 %.3lf us, p99 %.3lf us, max %.3lf us\n",
+				tcs[k],
+				( (sek > 0.0) ? n/sek : 0.0 ),
+				latenz[(VLONG)n*50/100] / 1000.0,
+				latenz[(VLONG)n*90/100] / 1000.0,
+				latenz[(VLONG)n*99/100] / 1000.0,
+				latenz[n-1] / 1000.0
+			);
+			LOGMSG2("%s",tmp);
+		}
+	}
+	
+	threadcount=merkthreads;
+	delete[] qx;
+	delete[] qy;
+	delete[] verdict;
+	delete[] latenz;
+	delete[] intp;
+	delete[] extp;
+	intp=extp=NULL;
+	
+	return 1;
+}
+
+// synthetic rectilinear polygons for the point-in-polygon
+// micro-benchmark, all on the grid 2^31 (coordinates
+// within +-2^30, i.e. complex numbers within +-0.5)
+
+const VLONG SYNTHNENNER=( (VLONG)1 << 31 );
+
+void synthStart(Polygon& apg,const VLONG anz) {
+	apg.setlen((int)(anz+64));
+	apg.nenner=SYNTHNENNER;
+	apg.cx0=apg.cy0=-1;
+	apg.cx1=apg.cy1=1;
+}
+
+void synthSpiral(Polygon& apg,const int anz) {
+	// square spiral corridor: centre line with m segments
+	// of lengths s,s,2s,2s,3s,... turning left, thickened
+	// by s/4 to either side, arms s apart
+	int m=maximumI(2,(anz-3) >> 1);
+	VLONG s=( (VLONG)1 << 31 ) / (m+4);
+	VLONG t=s >> 2;
+	const int DX[4]={1,0,-1,0};
+	const int DY[4]={0,1,0,-1};
+	
+	std::vector<VLONG> cx(m+1),cy(m+1);
+	cx[0]=cy[0]=0;
+	for(int j=0;j<m;j++) {
+		VLONG len=s*((j >> 1)+1);
+		cx[j+1]=cx[j] + DX[j & 3]*len;
+		cy[j+1]=cy[j] + DY[j & 3]*len;
+	}
+	
+	// left normal of direction d is direction d+1
+	#define SPIRALOFF(J,SIGN,XX,YY) \
+	{\
+		int din=( ((J)>0) ? (((J)-1) & 3) : 0 );\
+		int dout=( ((J)<m) ? ((J) & 3) : (((J)-1) & 3) );\
+		VLONG nx=DX[(din+1) & 3],ny=DY[(din+1) & 3];\
+		if ( ((J)>0) && ((J)<m) ) {\
+			nx += DX[(dout+1) & 3];\
+			ny += DY[(dout+1) & 3];\
+		}\
+		XX=(int)(cx[J] + (SIGN)*t*nx);\
+		YY=(int)(cy[J] + (SIGN)*t*ny);\
+	}
+	
+	synthStart(apg,2*(VLONG)m+8);
+	int x,y;
+	for(int j=0;j<=m;j++) {
+		SPIRALOFF(j,1,x,y)
+		apg.add(x,y);
+	}
+	for(int j=m;j>=0;j--) {
+		SPIRALOFF(j,-1,x,y)
+		apg.add(x,y);
+	}
+	SPIRALOFF(0,1,x,y)
+	apg.add(x,y);
+}
+
+void synthTeeth(Polygon& apg,const std::vector<int>& aa,const std::vector<int>& ab,const std::vector<int>& atop) {
+	// comb: base bar from y0 to y1, tooth j covers x in [aa[j],ab[j]]
+	// and reaches up to atop[j]. Teeth sorted and disjoint
+	int y0=-(1 << 30);
+	int y1=y0 + (1 << 28);
+	int k=(int)aa.size();
+	
+	synthStart(apg,4*(VLONG)k+8);
+	apg.add(aa[0],y0);
+	apg.add(ab[k-1],y0);
+	for(int j=k-1;j>=0;j--) {
+		apg.add(ab[j],atop[j]);
+		apg.add(aa[j],atop[j]);
+		if (j>0) {
+			apg.add(aa[j],y1);
+			apg.add(ab[j-1],y1);
+		}
+	}
+	apg.add(aa[0],y0);
+}
+
+void synthComb(Polygon& apg,const int anz) {
+	// equally spaced teeth of equal height
+	int k=maximumI(1,(anz-2) >> 2);
+	VLONG p=( (VLONG)1 << 31 ) / (k+1);
+	std::vector<int> aa(k),ab(k),top(k);
+	for(int j=0;j<k;j++) {
+		aa[j]=(int)(-((VLONG)1 << 30) + j*p);
+		ab[j]=(int)(aa[j] + (p >> 1));
+		top[j]=(1 << 30);
+	}
+	synthTeeth(apg,aa,ab,top);
+}
+
+void synthCantorRec(const int aa,const int ab,const int adepth,std::vector<int>& va,std::vector<int>& vb) {
+	if ( (adepth <= 0) || ((ab-aa) < 5) ) {
+		va.push_back(aa);
+		vb.push_back(ab);
+		return;
+	}
+	int g=maximumI(1,(ab-aa) >> 2);
+	int len=(ab-aa-g) >> 1;
+	synthCantorRec(aa,aa+len,adepth-1,va,vb);
+	synthCantorRec(ab-len,ab,adepth-1,va,vb);
+}
+
+void synthCantor(Polygon& apg,const int anz) {
+	// teeth on the intervals of a Cantor-like set (each
+	// interval keeps two outer parts, a quarter is removed),
+	// heights following the Cantor staircase of the tooth index
+	int depth=0;
+	while ( ((VLONG)4 << depth) < anz) depth++;
+	std::vector<int> aa,ab;
+	// width stays below 2^31 for int differences
+	synthCantorRec(-(1 << 30)+16,(1 << 30)-16,depth,aa,ab);
+	int k=(int)aa.size();
+	std::vector<int> top(k);
+	int y1=-(1 << 30) + (1 << 28);
+	VLONG hoehe=(VLONG)(1 << 30) - y1;
+	for(int j=0;j<k;j++) {
+		int tz=0;
+		while ( (tz<depth) && ( ((j >> tz) & 1) == 0) ) tz++;
+		top[j]=(int)(y1 + 16 + hoehe*(tz+1)/(depth+2));
+	}
+	synthTeeth(apg,aa,ab,top);
+}
+
+int edgesVisitedVH(Polygon& apg,const int ax,const int ay,const int* aprepare) {
+	// number of segments point_in_polygonVH looks at for
+	// this query: same bounding box test, same walk and
+	// the same early exit on a boundary hit
+	if (
+		(ax < apg.xmin) || (ax > apg.xmax) ||
+		(ay < apg.ymin) || (ay > apg.ymax) 
+	) return 0;
+	
+	int anz=0;
+	int i=0;
+	while (i<(apg.pointcount-1)) {
+		if (aprepare) i=aprepare[i]; else i++;
+		if (i >= apg.pointcount) break;
+		anz++;
+		int mix,max,miy,may;
+		getMinMax(apg.points[i].x,apg.points[i-1].x,mix,max);
+		getMinMax(apg.points[i].y,apg.points[i-1].y,miy,may);
+		if ( (mix <= ax) && (ax <= max) && (miy <= ay) && (ay <= may) ) break;
+	}
+	
+	return anz;
+}
+
+int pipBenchmark(void) {
+	const char* name[]={ "spiral","comb","cantor" };
+	// budget of edge visits per measurement
+	const double BUDGET=4e7;
+	const int ROW=64; // queries per prepared row
+	volatile int senke=0;
+	char tmp[1024];
+	
+	LOGMSG2("point-in-polygon micro-benchmark up to %i vertices\n",MAXVERTICES);
+	LOGMSG("ns per query and segments visited per query for point_in_polygonVH\n");
+	LOGMSG("on its own, with prepareY per row of 64 queries (included), and the\n");
+	LOGMSG("full 5x5 jsoracle stencil (polygon as the only interior polygon)\n\n");
+	
+	for(int form=0;form<3;form++) {
+		for(VLONG ziel=10;ziel<=MAXVERTICES;ziel *= 10) {
+			Polygon pg;
+			switch (form) {
+				case 0: synthSpiral(pg,(int)ziel); break;
+				case 1: synthComb(pg,(int)ziel); break;
+				default: synthCantor(pg,(int)ziel); break;
+			}
+			if ( (pg.isDiagonalFree() <= 0) || (pg.isColinearFree() <= 0) ) {
+				LOGMSG("\nERROR. Implementation. Synthetic polygon invalid.\n");
+				exit(99);
+			}
+			
+			int Q=(int)(BUDGET / pg.pointcount);
+			Q=maximumI(32,minimumI(100000,Q));
+			unsigned long long state=0x50495042ULL + form*1000 + ziel;
+			std::vector<int> gx(Q),gy(Q);
+			for(int i=0;i<Q;i++) {
+				// widths reach 2^31, so not in int
+				gx[i]=(int)(pg.xmin + benchUniform(state)*((double)pg.xmax-pg.xmin));
+				// the prepared test keeps one row for ROW queries
+				if ( (i % ROW) == 0) gy[i]=(int)(pg.ymin + benchUniform(state)*((double)pg.ymax-pg.ymin));
+				else gy[i]=gy[i-1];
+			}
+			
+			// plain
+			double kanten=0.0;
+			for(int i=0;i<Q;i++) kanten += edgesVisitedVH(pg,gx[i],gy[i],NULL);
+			auto t0=std::chrono::steady_clock::now();
+			for(int i=0;i<Q;i++) senke += point_in_polygonVH(pg,gx[i],gy[i]);
+			double nsplain=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count() / Q;
+			double kplain=kanten / Q;
+			
+			// prepared
+			kanten=0.0;
+			for(int i=0;i<Q;i++) {
+				if ( (i % ROW) == 0) pg.prepareY(gy[i]);
+				kanten += edgesVisitedVH(pg,gx[i],gy[i],pg.yprepare);
+			}
+			t0=std::chrono::steady_clock::now();
+			for(int i=0;i<Q;i++) {
+				if ( (i % ROW) == 0) pg.prepareY(gy[i]);
+				senke += point_in_polygonVH(pg,gx[i],gy[i]);
+			}
+			double nsprep=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count() / Q;
+			double kprep=kanten / Q;
+			pg.unPrepareY();
+			
+			// stencil: grid points counted as jsoracleWith walks
+			// them, i.e. up to the first non-interior one
+			int QS=maximumI(8,Q/25);
+			kanten=0.0;
+			for(int i=0;i<QS;i++) {
+				int ic=0;
+				for(int dy=-2;((ic>=0)&&(dy<=2));dy++) {
+					for(int dx=-2;((ic>=0)&&(dx<=2));dx++) {
+						kanten += edgesVisitedVH(pg,gx[i]+dx,gy[i]+dy,NULL);
+						if (point_in_polygonVH(pg,gx[i]+dx,gy[i]+dy) == PIP_INTERIOR) ic++; else ic=-1;
+					}
+				}
+			}
+			t0=std::chrono::steady_clock::now();
+			for(int i=0;i<QS;i++) {
+				senke += jsoracleWith(&pg,1,NULL,0,(double)gx[i] / pg.nenner,(double)gy[i] / pg.nenner);
+			}
+			double nsorakel=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-t0).count() / QS;
+			double korakel=kanten / QS;
+			
+			sprintf(tmp,"%-7s %9i vertices  pip %12.1lf ns %11.1lf seg  prepared %10.1lf ns %9.1lf seg  jsoracle %13.1lf ns %12.1lf seg\n",
+				name[form],pg.pointcount,nsplain,kplain,nsprep,kprep,nsorakel,korakel);
+			LOGMSG2("%s",tmp);
+		}
+	}
+	
+	return 1;
+}
+
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+//
+// differential test: every accelerated way of
+// answering a query against the plain reference
+// point_in_polygonVH / jsoracleWith
+//
+// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+struct DiffRun {
+	// reference set and its copies for the engines
+	PolygonSet ref,text,lazyset,bundle;
+	RowPrepare* rp;
+	int* chain; // for DIFF_ROWPREPARE on single polygons
+	double r0,r1;
+	
+	DiffRun();
+	virtual ~DiffRun();
+};
+
+DiffRun::DiffRun() {
+	rp=NULL;
+	chain=NULL;
+	r0=r1=0.0;
+}
+
+DiffRun::~DiffRun() {
+	if (rp) delete rp;
+	if (chain) delete[] chain;
+}
+
+const char* DIFFENGINENAME[]={ "reference","rowprepare","prepareY","text","lazy","bundle" };
+const char* DIFFCATNAME[]={ "random","edge-adjacent","vertex-coincident","collinear" };
+const char* PIPNAME[]={ "UNKNOWN","INTERIOR","BOUNDARY","EXTERIOR" };
+
+inline Polygon& diffPolygon(PolygonSet& aset,const int atyp,const int ai) {
+	return ( (atyp == 0) ? aset.intp[ai] : aset.extp[ai] );
+}
+
+int diffPip(const int aengine,DiffRun& r,const int atyp,const int ai,const int gx,const int gy,const int cy) {
+	// point_in_polygonVH of polygon ai (atyp 0: interior, 1: exterior)
+	// as the engine computes it, rows prepared for stencil row cy
+	Polygon& pg=diffPolygon(r.ref,atyp,ai);
+	int erg;
+	
+	switch (aengine) {
+		case DIFF_ROWPREPARE:
+			pg.prepareYTo(cy,r.chain);
+			return point_in_polygonVH(pg,gx,gy,r.chain);
+		case DIFF_PREPAREY:
+			pg.prepareY(cy);
+			erg=point_in_polygonVH(pg,gx,gy);
+			pg.unPrepareY();
+			return erg;
+		case DIFF_TEXT: {
+			Polygon& p2=diffPolygon(r.text,atyp,ai);
+			return point_in_polygonVH(p2,gx,gy);
+		}
+		case DIFF_LAZY: {
+			Polygon& p2=diffPolygon(r.lazyset,atyp,ai);
+			p2.ensureLoaded();
+			return point_in_polygonVH(p2,gx,gy);
+		}
+		case DIFF_BUNDLE: {
+			Polygon& p2=diffPolygon(r.bundle,atyp,ai);
+			return point_in_polygonVH(p2,gx,gy);
+		}
+		default: break;
+	}
+	
+	return point_in_polygonVH(pg,gx,gy);
+}
+
+int diffOracle(const int aengine,DiffRun& r,const double ax,const double ay) {
+	// the engine's verdict on the whole set, without symmetry folding
+	PolygonSet* s=&r.ref;
+	switch (aengine) {
+		case DIFF_ROWPREPARE:
+			r.rp->prepare(ay);
+			return jsoracleWith(s->intp,s->intpcount,s->extp,s->extpcount,ax,ay,r.rp);
+		case DIFF_PREPAREY: {
+			prepareYOracle(ay);
+			int erg=jsoracleWith(s->intp,s->intpcount,s->extp,s->extpcount,ax,ay);
+			unPrepareYOracle();
+			return erg;
+		}
+		case DIFF_TEXT: s=&r.text; break;
+		case DIFF_LAZY: s=&r.lazyset; break;
+		case DIFF_BUNDLE: s=&r.bundle; break;
+		default: break;
+	}
+	
+	return jsoracleWith(s->intp,s->intpcount,s->extp,s->extpcount,ax,ay);
+}
+
+void diffReproducer(DiffRun& r,const int atyp,const int ai,const int gx,const int gy,const int cy) {
+	char tmp[1024];
+	Polygon& pg=diffPolygon(r.ref,atyp,ai);
+	pg.save("_difftest_repro_poly");
+	sprintf(tmp,"  minimal reproducer: %s polygon %i (%i vertices, written to _difftest_repro_poly),\n  point_in_polygonVH at grid point (%i,%i), rows prepared for %i\n",
+		(atyp == 0) ? "interior" : "exterior",ai,pg.pointcount,gx,gy,cy);
+	LOGMSG2("%s",tmp);
+}
+
+int diffSet(const char* aname,DiffRun& r) {
+	// ref is loaded, r0/r1 set. Copies for the engines go
+	// through temporary files _DIFFTEST_*
+	char tmp[2048];
+	int anzp=r.ref.intpcount+r.ref.extpcount;
+	if (anzp <= 0) return 1;
+	
+	for(int i=0;i<r.ref.intpcount;i++) {
+		r.ref.intp[i].ensureLoaded();
+		sprintf(tmp,"_DIFFTEST_intpoly%04i",i);
+		r.ref.intp[i].save(tmp);
+	}
+	for(int i=0;i<r.ref.extpcount;i++) {
+		r.ref.extp[i].ensureLoaded();
+		sprintf(tmp,"_DIFFTEST_extpoly%04i",i);
+		r.ref.extp[i].save(tmp);
+	}
+	r.text.load("_DIFFTEST_");
+	r.lazyset.load("_DIFFTEST_",1);
+	
+	// bundle and row preparation work on the global set
+	Polygon *merkint=intp,*merkext=extp;
+	int merkintc=intpcount,merkextc=extpcount;
+	intp=r.ref.intp; intpcount=r.ref.intpcount;
+	extp=r.ref.extp; extpcount=r.ref.extpcount;
+	writeBundle("_DIFFTEST_.BUNDLE");
+	mapBundle("_DIFFTEST_.BUNDLE",r.bundle.intp,r.bundle.intpcount,r.bundle.extp,r.bundle.extpcount);
+	r.rp=new RowPrepare;
+	
+	int maxpc=1;
+	for(int k=0;k<anzp;k++) {
+		Polygon& pg=( (k<r.ref.intpcount) ? r.ref.intp[k] : r.ref.extp[k-r.ref.intpcount] );
+		maxpc=maximumI(maxpc,pg.pointcount);
+	}
+	r.chain=new int[maxpc];
+	
+	int ok=1;
+	if ( (r.text.intpcount != r.ref.intpcount) || (r.lazyset.intpcount != r.ref.intpcount) || (r.bundle.intpcount != r.ref.intpcount) ||
+		(r.text.extpcount != r.ref.extpcount) || (r.lazyset.extpcount != r.ref.extpcount) || (r.bundle.extpcount != r.ref.extpcount) ) {
+		LOGMSG2("\nDIFFTEST set '%s': engines load a different number of polygons\n",aname);
+		ok=0;
+	}
+	
+	// random edge weighted by edge count
+	std::vector<VLONG> kum(anzp+1,0);
+	for(int k=0;k<anzp;k++) {
+		Polygon& pg=( (k<r.ref.intpcount) ? r.ref.intp[k] : r.ref.extp[k-r.ref.intpcount] );
+		kum[k+1]=kum[k] + maximumI(pg.pointcount-1,0);
+	}
+	
+	VLONG vergleiche=0;
+	for(int cat=0;((ok>0)&&(cat<DIFFCATEGORIES));cat++) {
+		unsigned long long state=0x4449464654ULL + cat*7919 + anzp;
+		for(int n=0;((ok>0)&&(n<DIFFCOUNT));n++) {
+			VLONG k=(VLONG)(benchRandom(state) % (unsigned long long)maximumI(1,(int)minimumI(kum[anzp],0x7FFFFFFF)));
+			int q=(int)(std::upper_bound(kum.begin(),kum.end(),k)-kum.begin())-1;
+			if (q >= anzp) q=anzp-1;
+			int typ=( (q<r.ref.intpcount) ? 0 : 1 );
+			int i=( (typ == 0) ? q : q-r.ref.intpcount );
+			Polygon& pg=diffPolygon(r.ref,typ,i);
+			int e=( (pg.pointcount > 1) ? (int)(k-kum[q]) : 0 );
+			PolygonPoint& a=pg.points[e];
+			PolygonPoint& b=pg.points[minimumI(e+1,pg.pointcount-1)];
+			int gx,gy;
+			
+			#define DIFFOFF(W) ( (int)(benchRandom(state) % (2*(W)+1)) - (W) )
+			
+			switch (cat) {
+				case DIFF_RANDOM: {
+					double x=r.r0 + benchUniform(state)*(r.r1-r.r0);
+					double y=r.r0 + benchUniform(state)*(r.r1-r.r0);
+					gx=(int)floor(x*pg.nenner);
+					gy=(int)floor(y*pg.nenner);
+					break;
+				}
+				case DIFF_EDGE: {
+					double t=benchUniform(state);
+					gx=(int)(a.x + t*((double)b.x-a.x)) + DIFFOFF(3);
+					gy=(int)(a.y + t*((double)b.y-a.y)) + DIFFOFF(3);
+					break;
+				}
+				case DIFF_VERTEX:
+					gx=a.x + DIFFOFF(2);
+					gy=a.y + DIFFOFF(2);
+					break;
+				default: {
+					// on the line through the segment, beyond its ends
+					VLONG len=maximumI(1,abs(b.x-a.x)+abs(b.y-a.y));
+					int weg=1 + (int)(benchRandom(state) % (unsigned long long)(2*len));
+					int vor=( (benchRandom(state) & 1) ? 1 : -1 );
+					if (a.y == b.y) {
+						gy=a.y;
+						gx=( (vor > 0) ? maximumI(a.x,b.x)+weg : minimumI(a.x,b.x)-weg );
+					} else {
+						gx=a.x;
+						gy=( (vor > 0) ? maximumI(a.y,b.y)+weg : minimumI(a.y,b.y)-weg );
+					}
+					break;
+				}
+			}
+			int cy=gy + DIFFOFF(2);
+			
+			// single polygon
+			int referenz=diffPip(DIFF_REFERENCE,r,typ,i,gx,gy,cy);
+			for(int eng=DIFF_REFERENCE+1;eng<DIFFENGINES;eng++) {
+				vergleiche++;
+				int erg=diffPip(eng,r,typ,i,gx,gy,cy);
+				if (erg != referenz) {
+					sprintf(tmp,"\nDIFFTEST set '%s' engine '%s' category '%s': first disagreement\n  reference %s, engine %s\n",
+						aname,DIFFENGINENAME[eng],DIFFCATNAME[cat],PIPNAME[referenz & 3],PIPNAME[erg & 3]);
+					LOGMSG2("%s",tmp);
+					diffReproducer(r,typ,i,gx,gy,cy);
+					ok=0;
+					break;
+				}
+			}
+			if (ok <= 0) break;
+			
+			// whole oracle, stencil centre near the grid point,
+			// exactly on it or somewhere within its grid cell
+			double fx=( (n & 1) ? benchUniform(state) : 0.0 );
+			double fy=( (n & 2) ? benchUniform(state) : 0.0 );
+			double x=(gx + DIFFOFF(2) + fx) / pg.nenner;
+			double y=(gy + DIFFOFF(2) + fy) / pg.nenner;
+			referenz=diffOracle(DIFF_REFERENCE,r,x,y);
+			for(int eng=DIFF_REFERENCE+1;eng<DIFFENGINES;eng++) {
+				vergleiche++;
+				int erg=diffOracle(eng,r,x,y);
+				if (erg == referenz) continue;
+				
+				sprintf(tmp,"\nDIFFTEST set '%s' engine '%s' category '%s': first disagreement\n  oracle at (%.20lg,%.20lg): reference %s, engine %s\n",
+					aname,DIFFENGINENAME[eng],DIFFCATNAME[cat],x,y,PIPNAME[referenz & 3],PIPNAME[erg & 3]);
+				LOGMSG2("%s",tmp);
+				// reduce to one polygon and one grid point
+				int gefunden=0;
+				for(int t2=0;((gefunden<=0)&&(t2<2));t2++) {
+					int anz2=( (t2 == 0) ? r.ref.intpcount : r.ref.extpcount );
+					for(int i2=0;((gefunden<=0)&&(i2<anz2));i2++) {
+						Polygon& p2=diffPolygon(r.ref,t2,i2);
+						int px=(int)floor(x*p2.nenner);
+						int py=(int)floor(y*p2.nenner);
+						for(int dy=-2;((gefunden<=0)&&(dy<=2));dy++) {
+							for(int dx=-2;((gefunden<=0)&&(dx<=2));dx++) {
+								if (diffPip(DIFF_REFERENCE,r,t2,i2,px+dx,py+dy,py) != diffPip(eng,r,t2,i2,px+dx,py+dy,py)) {
+									diffReproducer(r,t2,i2,px+dx,py+dy,py);
+									gefunden=1;
+								}
+							}
+						}
+					}
+				}
+				if (gefunden <= 0) LOGMSG("  no single point-in-polygon test differs, the engine combines them differently\n");
+				ok=0;
+				break;
+			}
+		} // n
+	} // cat
+	
+	// scanline engine of the QC C-test: whole pixel rows
+	// against the interior-only and exterior-only oracle.
+	// Rows through vertex neighbourhoods, pixels on, between
+	// and coarser than the grid points
+	ScanSet scan;
+	if ( (ok > 0) && (scan.init(r.ref.intp,r.ref.intpcount,r.ref.extp,r.ref.extpcount) > 0) ) {
+		const int SCANBREITE=256;
+		ScanCursor cursor(&scan);
+		std::vector<int> sgx(SCANBREITE);
+		std::vector<BYTE> sint(SCANBREITE),sext(SCANBREITE);
+		unsigned long long state=0x5343414EULL + anzp;
+		int zeilen=maximumI(8,DIFFCOUNT/50);
+		for(int n=0;((ok>0)&&(n<zeilen));n++) {
+			VLONG k=(VLONG)(benchRandom(state) % (unsigned long long)maximumI(1,(int)minimumI(kum[anzp],0x7FFFFFFF)));
+			int q=(int)(std::upper_bound(kum.begin(),kum.end(),k)-kum.begin())-1;
+			if (q >= anzp) q=anzp-1;
+			Polygon& pg=( (q<r.ref.intpcount) ? r.ref.intp[q] : r.ref.extp[q-r.ref.intpcount] );
+			if (pg.pointcount <= 0) continue;
+			PolygonPoint& a=pg.points[(int)(k-kum[q]) % pg.pointcount];
+			double schritt;
+			switch (n & 3) {
+				case 0: schritt=1.0/scan.nenner; break;
+				case 1: schritt=0.37/scan.nenner; break;
+				case 2: schritt=5.3/scan.nenner; break;
+				default: schritt=(r.r1-r.r0)/SCANBREITE; break;
+			}
+			double y=(a.y + DIFFOFF(3) + ( (n & 4) ? benchUniform(state) : 0.0 )) / scan.nenner;
+			double x0=(a.x + DIFFOFF(3)) / scan.nenner - 0.5*SCANBREITE*schritt;
+			if ((n & 3) == 3) x0=r.r0;
+			for(int m=0;m<SCANBREITE;m++) sgx[m]=(int)floor((x0 + m*schritt)*scan.nenner);
+			cursor.classifyRow(y,&sgx[0],SCANBREITE,&sint[0],&sext[0]);
+
+			for(int m=0;m<SCANBREITE;m++) {
+				double x=x0 + m*schritt;
+				int refint=( (jsoracleWith(r.ref.intp,r.ref.intpcount,NULL,0,x,y) == PIP_INTERIOR) ? 1 : 0 );
+				int refext=( (jsoracleWith(NULL,0,r.ref.extp,r.ref.extpcount,x,y) == PIP_EXTERIOR) ? 1 : 0 );
+				vergleiche += 2;
+				if ( (refint == sint[m]) && (refext == sext[m]) ) continue;
+
+				int t2=( (refint != sint[m]) ? 0 : 1 );
+				sprintf(tmp,"\nDIFFTEST set '%s' engine 'scanline': first disagreement\n  %s-only oracle at (%.20lg,%.20lg): reference %s, engine %s\n",
+					aname,(t2 == 0) ? "interior" : "exterior",x,y,
+					( (t2 == 0) ? refint : refext ) ? "yes" : "no",
+					( (t2 == 0) ? sint[m] : sext[m] ) ? "yes" : "no");
+				LOGMSG2("%s",tmp);
+				// reduce to one polygon and one grid point
+				int gefunden=0;
+				int anz2=( (t2 == 0) ? r.ref.intpcount : r.ref.extpcount );
+				for(int i2=0;((gefunden<=0)&&(i2<anz2));i2++) {
+					Polygon& p2=diffPolygon(r.ref,t2,i2);
+					if (p2.pointcount <= 0) continue;
+					ScanPolygon sp;
+					sp.init(&p2);
+					int px=(int)floor(x*p2.nenner);
+					int py=(int)floor(y*p2.nenner);
+					for(int dy=-2;((gefunden<=0)&&(dy<=2));dy++) {
+						for(int dx=-2;((gefunden<=0)&&(dx<=2));dx++) {
+							if (point_in_polygonVH(p2,px+dx,py+dy) != sp.classify(px+dx,py+dy)) {
+								diffReproducer(r,t2,i2,px+dx,py+dy,py);
+								gefunden=1;
+							}
+						}
+					}
+				}
+				if (gefunden <= 0) LOGMSG("  no single grid point differs, the rows are combined differently\n");
+				ok=0;
+				break;
+			}
+		} // n
+	}
+
+	intp=merkint; intpcount=merkintc;
+	extp=merkext; extpcount=merkextc;
+	
+	// temporary files
+	for(int i=0;i<r.ref.intpcount;i++) {
+		sprintf(tmp,"_DIFFTEST_intpoly%04i",i);
+		remove(tmp);
+	}
+	for(int i=0;i<r.ref.extpcount;i++) {
+		sprintf(tmp,"_DIFFTEST_extpoly%04i",i);
+		remove(tmp);
+	}
+	remove("_DIFFTEST_.BUNDLE");
+	
+	if (ok > 0) {
+		sprintf(tmp,"set '%s': %i interior, %i exterior polygons, %lld comparisons, no disagreement\n",
+			aname,r.ref.intpcount,r.ref.extpcount,(long long)vergleiche);
+		LOGMSG2("%s",tmp);
+	}
+	
+	return ok;
+}
+
+int diffTest(void) {
+	// symmetry folding is not an engine, compare raw sets
+	int merksym=symmetry;
+	int ok=1;
+	
+	printf("differential test of the oracle engines against the reference\n");
+	
+	// polygon set of the current directory (POLYPATH or BUNDLE)
+	loadAllPolygons();
+	symmetry=SYM_NONE;
+	if ( (intpcount > 0) || (extpcount > 0) ) {
+		DiffRun r;
+		r.ref.intp=intp; r.ref.intpcount=intpcount;
+		r.ref.extp=extp; r.ref.extpcount=extpcount;
+		intp=extp=NULL;
+		intpcount=extpcount=0;
+		r.r0=RANGE0;
+		r.r1=RANGE1;
+		ok=diffSet("polygons",r);
+	} else {
+		LOGMSG("no polygon set in the current directory, synthetic set only\n");
+	}
+	
+	if (ok > 0) {
+		// synthetic set: spiral, comb and Cantor comb
+		// as interior, comb and spiral as exterior polygons
+		DiffRun r;
+		r.ref.intpcount=3;
+		r.ref.extpcount=2;
+		r.ref.intp=new Polygon[3];
+		r.ref.extp=new Polygon[2];
+		synthSpiral(r.ref.intp[0],401);
+		synthComb(r.ref.intp[1],202);
+		synthCantor(r.ref.intp[2],600);
+		synthComb(r.ref.extp[0],62);
+		synthSpiral(r.ref.extp[1],121);
+		r.r0=-0.5;
+		r.r1=0.5;
+		ok=diffSet("synthetic",r);
+	}
+	
+	symmetry=merksym;
+	
+	if (ok > 0) {
+		LOGMSG("\nDIFFTEST PASSED: all engines agree with the reference.\n");
+	} else {
+		LOGMSG("\nDIFFTEST FAILED.\n");
+	}
+	
+	return ok;
+}
+
+int borderPresent(Charmap& md) {
+	// image must have a white border. 
+	int D=BORDERWIDTH;
+	
+	int border=1;
+	// as image is quadratic, x/y can be interchanged
+	for(int a=0;a<D;a++) {
+		for(int b=0;b<md.xlen;b++) {
+			if (
+				(md.getPoint(a,b) != COLORWHITE) ||
+				(md.getPoint(md.xlen-1-a,b) != COLORWHITE) ||
+				(md.getPoint(b,a) != COLORWHITE) ||
+				(md.getPoint(b,md.ylen-1-a) != COLORWHITE)
+			) {
+				border=0;
+				break;
+			}
+		}
+		
+		if (border<=0) break;
+	} // 
+	
+	return border;
+}
+
+// main entry
 int main(int argc,char** argv) {
 	flog=fopen("polygon.log","at");
 	if (flog) fprintf(flog,"\n\n---------------\n");
@@ -1847,12 +6810,31 @@ int main(int argc,char** argv) {
 	orakelfn[0]=0;
 	LOWERBOUNDPOLYGONLENGTH=24;
 	
+	#ifdef ORACLECOUNTERS
+	atexit(oracleCountersAtExit);
+	#endif
+	
 	// command line parameters
 	// cmd=[makeint,makeext,quality,oracle]
 	// range=a,b
 	// granularity=n
+	// kernelstride=n
+	// kerneloffset=n
+	// layout=rows|tiled
 	// minpollen=n
 	// point=x,y or point=file
+	// threads=n
+	// tilesize=n
+	// tilelevels=n
+	// polypath=prefix
+	// cascade=prefix,prefix,...
+	// genname=identifier
+	// lazy=1
+	// bundle=filename
+	// symmetry=point|conj
+	// benchcount=n
+	// maxvertices=n
+	// diffcount=n
 	
 	for(int i=1;i<argc;i++) {
 		upper(argv[i]);
@@ -1861,6 +6843,15 @@ int main(int argc,char** argv) {
 			else if (strcmp(&argv[i][4],"MAKEEXT")==0) cmd=CMD_MAKEEXT;
 			else if (strcmp(&argv[i][4],"ORACLE")==0) cmd=CMD_ORACLE;
 			else if (strcmp(&argv[i][4],"QUALITY")==0) cmd=CMD_QUALITY;
+			else if (strcmp(&argv[i][4],"TILES")==0) cmd=CMD_TILES;
+			else if (strcmp(&argv[i][4],"GENHEADER")==0) cmd=CMD_GENHEADER;
+			else if (strcmp(&argv[i][4],"TOBUNDLE")==0) cmd=CMD_TOBUNDLE;
+			else if (strcmp(&argv[i][4],"FROMBUNDLE")==0) cmd=CMD_FROMBUNDLE;
+			else if (strcmp(&argv[i][4],"BENCH")==0) cmd=CMD_BENCH;
+			else if (strcmp(&argv[i][4],"PIPBENCH")==0) cmd=CMD_PIPBENCH;
+			else if (strcmp(&argv[i][4],"DIFFTEST")==0) cmd=CMD_DIFFTEST;
+			else if (strcmp(&argv[i][4],"QCMERGE")==0) cmd=CMD_QCMERGE;
+			else if (strcmp(&argv[i][4],"AREA")==0) cmd=CMD_AREA;
 		} else
 		if (strstr(argv[i],"RANGE=")==argv[i]) {
 			if (sscanf(&argv[i][6],"%i,%i",&RANGE0,&RANGE1) != 2) {
@@ -1885,9 +6876,171 @@ int main(int argc,char** argv) {
 			if (sscanf(&argv[i][12],"%i",&granularity) != 1) {
 				granularity=5;
 			}
+		} else
+		if (strstr(argv[i],"KERNELSTRIDE=")==argv[i]) {
+			if ( (sscanf(&argv[i][13],"%i",&kernelstride) != 1) || (kernelstride < 0) ) {
+				kernelstride=0;
+			}
+		} else
+		if (strstr(argv[i],"KERNELOFFSET=")==argv[i]) {
+			if ( (sscanf(&argv[i][13],"%i",&kerneloffset) != 1) || (kerneloffset < 0) ) {
+				kerneloffset=0;
+			}
+		} else
+		if (strstr(argv[i],"LAYOUT=")==argv[i]) {
+			if (strcmp(&argv[i][7],"TILED")==0) charmaplayout=LAYOUT_TILED;
+			else charmaplayout=LAYOUT_ROWS;
+		} else
+		if (strstr(argv[i],"THREADS=")==argv[i]) {
+			if (sscanf(&argv[i][8],"%i",&threadcount) != 1) {
+				threadcount=0;
+			}
+		} else
+		if (strstr(argv[i],"TILESIZE=")==argv[i]) {
+			if (sscanf(&argv[i][9],"%i",&TILESIZE) != 1) {
+				TILESIZE=256;
+			}
+		} else
+		if (strstr(argv[i],"TILELEVELS=")==argv[i]) {
+			if (sscanf(&argv[i][11],"%i",&TILELEVELS) != 1) {
+				TILELEVELS=4;
+			}
+		} else
+		if (strstr(argv[i],"BUNDLE=")==argv[i]) {
+			if (strlen(argv[i])>1000) argv[i][1000]=0;
+			strcpy(bundlefn,&argv[i][7]);
+		} else
+		if (strstr(argv[i],"BENCHCOUNT=")==argv[i]) {
+			if ( (sscanf(&argv[i][11],"%i",&BENCHCOUNT) != 1) || (BENCHCOUNT < 1) ) {
+				BENCHCOUNT=100000;
+			}
+		} else
+		if (strstr(argv[i],"MAXVERTICES=")==argv[i]) {
+			if ( (sscanf(&argv[i][12],"%i",&MAXVERTICES) != 1) || (MAXVERTICES < 10) ) {
+				MAXVERTICES=10000000;
+			}
+		} else
+		if (strstr(argv[i],"DIFFCOUNT=")==argv[i]) {
+			if ( (sscanf(&argv[i][10],"%i",&DIFFCOUNT) != 1) || (DIFFCOUNT < 1) ) {
+				DIFFCOUNT=20000;
+			}
+		} else
+		if (strstr(argv[i],"QCGEOMETRIC=")==argv[i]) {
+			if (sscanf(&argv[i][12],"%i",&qcgeometric) != 1) {
+				qcgeometric=1;
+			}
+		} else
+		if (strstr(argv[i],"QCCACHE=")==argv[i]) {
+			if (sscanf(&argv[i][8],"%i",&qccache) != 1) {
+				qccache=0;
+			}
+		} else
+		if (strstr(argv[i],"SHARD=")==argv[i]) {
+			if ( (sscanf(&argv[i][6],"%i/%i",&qcshard,&qcshards) != 2) || (qcshards < 1) || (qcshard < 0) || (qcshard >= qcshards) ) {
+				qcshard=qcshards=0;
+			}
+		} else
+		if (strstr(argv[i],"RESUME=")==argv[i]) {
+			if (sscanf(&argv[i][7],"%i",&qcresume) != 1) {
+				qcresume=0;
+			}
+		} else
+		if (strstr(argv[i],"CHECKPOINT=")==argv[i]) {
+			if (sscanf(&argv[i][11],"%i",&qccheckpointsek) != 1) {
+				qccheckpointsek=60;
+			}
+		} else
+		if (strstr(argv[i],"QCREPORT=")==argv[i]) {
+			if (strcmp(&argv[i][9],"ALL")==0) qcreport=QCREPORT_ALL;
+			else qcreport=QCREPORT_FIRST;
+		} else
+		if (strstr(argv[i],"QCMODE=")==argv[i]) {
+			if (strcmp(&argv[i][7],"TIERED")==0) qcmode=QCMODE_TIERED;
+			else qcmode=QCMODE_FULL;
+		} else
+		if (strstr(argv[i],"QCSAMPLES=")==argv[i]) {
+			if (sscanf(&argv[i][10],"%i",&qcsamples) != 1) {
+				qcsamples=65536;
+			}
+			if (qcsamples < 1) qcsamples=1;
+		} else
+		if (strstr(argv[i],"QCTEST=")==argv[i]) {
+			if (strcmp(&argv[i][7],"PIXEL")==0) qctest=QCTEST_PIXEL;
+			else qctest=QCTEST_SCANLINE;
+		} else
+		if (strstr(argv[i],"SYMMETRY=")==argv[i]) {
+			if (strcmp(&argv[i][9],"POINT")==0) symmetryarg=SYM_POINT;
+			else if (strcmp(&argv[i][9],"CONJ")==0) symmetryarg=SYM_CONJ;
+			else if (strcmp(&argv[i][9],"NONE")==0) symmetryarg=SYM_NONE;
+		} else
+		if (strstr(argv[i],"LAZY=")==argv[i]) {
+			if (sscanf(&argv[i][5],"%i",&lazyload) != 1) {
+				lazyload=0;
+			}
+		} else
+		if (strstr(argv[i],"GENNAME=")==argv[i]) {
+			if (strlen(argv[i])>1000) argv[i][1000]=0;
+			strcpy(genname,&argv[i][8]);
+		} else
+		if (strstr(argv[i],"POLYPATH=")==argv[i]) {
+			if (strlen(argv[i])>1000) argv[i][1000]=0;
+			strcpy(polypath,&argv[i][9]);
+		} else
+		if (strstr(argv[i],"CASCADE=")==argv[i]) {
+			// comma separated prefixes, coarse to fine
+			// an empty entry denotes the unprefixed set
+			cascadecount=0;
+			char* s=&argv[i][8];
+			while (cascadecount<MAXCASCADE) {
+				char* komma=strchr(s,',');
+				int len=(komma ? (int)(komma-s) : (int)strlen(s));
+				if (len>1000) len=1000;
+				memcpy(cascadepath[cascadecount],s,len);
+				cascadepath[cascadecount][len]=0;
+				cascadecount++;
+				if (!komma) break;
+				s=komma+1;
+			}
 		} 
 	} // i
 	
+	if ( (cmd==CMD_TOBUNDLE) || (cmd==CMD_FROMBUNDLE) ) {
+		// conversion does not need the image
+		if (!bundlefn[0]) strcpy(bundlefn,"_POLYGONS.BUNDLE");
+		if (cmd==CMD_TOBUNDLE) polygonsToBundle();
+		else bundleToPolygons();
+		if (flog) fclose(flog);
+		return 0;
+	}
+	
+	if (cmd==CMD_BENCH) {
+		// works on the polygons alone
+		benchmark();
+		if (flog) fclose(flog);
+		return 0;
+	}
+	
+	if (cmd==CMD_PIPBENCH) {
+		// synthetic polygons only
+		pipBenchmark();
+		if (flog) fclose(flog);
+		return 0;
+	}
+	
+	if (cmd==CMD_DIFFTEST) {
+		int erg=diffTest();
+		if (flog) fclose(flog);
+		return ( (erg > 0) ? 0 : 1 );
+	}
+	
+	if ( (cmd==CMD_ORACLE) && ( (lazyload>0) || (bundlefn[0]) ) ) {
+		// the oracle itself does not need the image, so
+		// skip reading it for a fast start (lazy or mapped)
+		oracle(orakelfn,px,py);
+		if (flog) fclose(flog);
+		return 0;
+	}
+	
 	printf("loading image ...\n");
 	if (inbild.loadAsBmp("_in.bmp") <= 0) {
 		LOGMSG("\nERROR. Image _in.bmp not found.\n");
@@ -1909,10 +7062,38 @@ int main(int argc,char** argv) {
 	SCREENBREITE=inbild.xlen;
 	calcSkala();
 	
+	if ( (cmd==CMD_MAKEINT) || (cmd==CMD_MAKEEXT) ) {
+		// both polygon types of one prefix must be built with
+		// the same symmetry, as they share the marker
+		int stored=loadSymmetry(polypath);
+		symmetry=( (symmetryarg >= 0) ? symmetryarg : SYM_NONE );
+		if ( (stored != SYM_NONE) && (stored != symmetry) ) {
+			LOGMSG2("\nERROR. Polygons are marked with a different symmetry. Use the same SYMMETRY= or delete %spolysymmetry.\n",polypath);
+			exit(99);
+		}
+		if (symmetry != SYM_NONE) {
+			if (RANGE0 != -RANGE1) {
+				LOGMSG("\nERROR. SYMMETRY= needs a symmetric range.\n");
+				exit(99);
+			}
+			if (imageSymmetric(inbild,symmetry) <= 0) {
+				LOGMSG("\nERROR. Image is not symmetric as stated by SYMMETRY=.\n");
+				exit(99);
+			}
+		}
+	}
+	
 	if (cmd==CMD_MAKEINT) interiorPolygon();
 	else if (cmd==CMD_MAKEEXT) exteriorPolygon();
 	else if (cmd==CMD_ORACLE) oracle(orakelfn,px,py);
-	else if (cmd==CMD_QUALITY) qualitycontrol();
+	else if (cmd==CMD_QUALITY) {
+		if (qcshards > 0) qcShard();
+		else qualitycontrol();
+	}
+	else if (cmd==CMD_QCMERGE) qcMerge();
+	else if (cmd==CMD_AREA) polygonArea();
+	else if (cmd==CMD_TILES) tilePyramid();
+	else if (cmd==CMD_GENHEADER) generateHeader();
 	
 	if (flog) fclose(flog);
 